@@ -0,0 +1,98 @@
+/*
+ * BinaryFrame.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Binary input (--binary) is a stream of frames, each one a header followed
+ * by numValues doubles in host byte order. Value i of a frame is a sample
+ * for the i:th -y channel.
+ */
+struct BinaryFrameHeader {
+	uint32_t magic;
+	uint32_t numValues;
+};
+
+enum { BINARY_FRAME_MAGIC = 0x50444d52 }; // "RMDP" in a little endian dump
+
+enum { BINARY_FRAME_MAX_VALUES = 65536 };
+
+
+/**
+ * Splits chunks of input (as read from a file descriptor) into binary frames.
+ */
+class BinaryFrameSplitter {
+public:
+	BinaryFrameSplitter() : _failed(false)
+	{ }
+
+	/**
+	 * Calls fn(values, numValues, frameBytes) for each frame completed by data
+	 * @return false if sync was lost in data, as it doesn't look like frames.
+	 *         All further data is then ignored.
+	 */
+	template<class Fn>
+	bool push(const char* data, size_t size, Fn& fn)
+	{
+		if (_failed)
+		{
+			return true;
+		}
+		_buffer.insert(_buffer.end(), data, data + size);
+
+		size_t pos = 0;
+		BinaryFrameHeader header;
+		while (_buffer.size() - pos >= sizeof(header))
+		{
+			memcpy(&header, &_buffer[pos], sizeof(header));
+			if (header.magic != BINARY_FRAME_MAGIC || header.numValues > BINARY_FRAME_MAX_VALUES)
+			{
+				_failed = true;
+				_buffer.clear();
+				return false;
+			}
+
+			size_t frameBytes = sizeof(header) + header.numValues * sizeof(double);
+			if (_buffer.size() - pos < frameBytes)
+			{
+				break;
+			}
+
+			// The frame is not necessarily aligned for doubles in the buffer
+			_values.resize(header.numValues);
+			memcpy(_values.data(), &_buffer[pos + sizeof(header)], header.numValues * sizeof(double));
+			fn(_values.data(), _values.size(), frameBytes);
+			pos += frameBytes;
+		}
+
+		_buffer.erase(_buffer.begin(), _buffer.begin() + pos);
+		return true;
+	}
+
+	/**
+	 * Discards an incomplete last frame (at the end of input, or of a datagram)
+	 * @return number of bytes discarded
+	 */
+	size_t finish()
+	{
+		size_t discarded = _buffer.size();
+		_buffer.clear();
+		return discarded;
+	}
+
+private:
+	bool _failed;
+	std::vector<char> _buffer;
+	std::vector<double> _values;
+};
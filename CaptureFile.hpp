@@ -0,0 +1,453 @@
+/*
+ * CaptureFile.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Binary capture files (--record / --replay), all in host byte order:
+ *
+ *   CaptureFileHeader
+ *   numChannels x (uint32_t length, name bytes)
+ *   chunks: CaptureChunkHeader, followed by numSamples doubles
+ *   index: numChunks x CaptureIndexEntry
+ *   CaptureFileFooter
+ *
+ * Every chunk holds consecutive samples of one channel. Only the times of
+ * the first and last sample are kept, and the ones in between are spread
+ * out evenly on replay. A file without footer (as left by a crash) is
+ * still readable, by scanning the chunks.
+ */
+
+struct CaptureFileHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t numChannels;
+};
+
+struct CaptureChunkHeader {
+	uint32_t magic;
+	uint32_t channel;
+	uint32_t numSamples;
+	uint32_t reserved;
+	int64_t firstTimeNs;  // since the start of the recording
+	int64_t lastTimeNs;
+};
+
+struct CaptureIndexEntry {
+	uint64_t offset;  // of the samples
+	CaptureChunkHeader chunk;
+};
+
+struct CaptureFileFooter {
+	uint64_t indexOffset;
+	uint32_t numChunks;
+	uint32_t magic;
+};
+
+enum {
+	CAPTURE_FILE_VERSION = 1,
+	CAPTURE_CHUNK_MAGIC = 0x4b4e4843,  // "CHNK" in a little endian dump
+	CAPTURE_INDEX_MAGIC = 0x58444e49,  // "INDX"
+};
+
+static const char CAPTURE_FILE_MAGIC[8] = { 'R', 'M', 'D', 'P', 'C', 'A', 'P', '\n' };
+
+
+/**
+ * Writes samples of several channels into a capture file, buffering
+ * chunkSamples samples per channel.
+ */
+class CaptureWriter {
+public:
+	explicit CaptureWriter(size_t chunkSamples = 4096) :
+		_chunkSamples(chunkSamples),
+		_file(0),
+		_ok(false)
+	{ }
+
+	~CaptureWriter()
+	{
+		close();
+	}
+
+	/**
+	 * @return false if the file could not be created
+	 */
+	bool open(const std::string& fileName, const std::vector<std::string>& channelNames)
+	{
+		close();
+		_file = fopen(fileName.c_str(), "wb");
+		if (!_file)
+		{
+			return false;
+		}
+		_ok = true;
+
+		CaptureFileHeader header;
+		memcpy(header.magic, CAPTURE_FILE_MAGIC, sizeof(header.magic));
+		header.version = CAPTURE_FILE_VERSION;
+		header.numChannels = channelNames.size();
+		writeBytes(&header, sizeof(header));
+		for (const auto& name : channelNames)
+		{
+			uint32_t length = name.size();
+			writeBytes(&length, sizeof(length));
+			writeBytes(name.data(), length);
+		}
+
+		_channels.assign(channelNames.size(), Channel());
+		for (auto& channel : _channels)
+		{
+			channel.samples.reserve(_chunkSamples);
+		}
+		_index.clear();
+		return _ok;
+	}
+
+	bool isOpen() const { return _file != 0; }
+
+	void write(size_t channel, double value, int64_t timeNs)
+	{
+		Channel& c = _channels[channel];
+		if (c.samples.empty())
+		{
+			c.firstTimeNs = timeNs;
+		}
+		c.samples.push_back(value);
+		c.lastTimeNs = timeNs;
+		if (c.samples.size() >= _chunkSamples)
+		{
+			writeChunk(channel);
+		}
+	}
+
+	/**
+	 * Writes what is buffered, the index and the footer
+	 * @return false if anything failed to be written
+	 */
+	bool close()
+	{
+		if (!_file)
+		{
+			return false;
+		}
+
+		for (size_t channel = 0; channel < _channels.size(); channel++)
+		{
+			if (!_channels[channel].samples.empty())
+			{
+				writeChunk(channel);
+			}
+		}
+
+		CaptureFileFooter footer;
+		footer.indexOffset = ftello(_file);
+		footer.numChunks = _index.size();
+		footer.magic = CAPTURE_INDEX_MAGIC;
+		if (!_index.empty())
+		{
+			writeBytes(&_index[0], _index.size() * sizeof(_index[0]));
+		}
+		writeBytes(&footer, sizeof(footer));
+
+		bool ok = (fclose(_file) == 0) && _ok;
+		_file = 0;
+		return ok;
+	}
+
+private:
+	struct Channel {
+		std::vector<double> samples;
+		int64_t firstTimeNs;
+		int64_t lastTimeNs;
+		Channel() : firstTimeNs(0), lastTimeNs(0)
+		{ }
+	};
+
+	size_t _chunkSamples;
+	FILE* _file;
+	bool _ok;
+	std::vector<Channel> _channels;
+	std::vector<CaptureIndexEntry> _index;
+
+	void writeBytes(const void* data, size_t size)
+	{
+		if (size && fwrite(data, size, 1, _file) != 1)
+		{
+			_ok = false;
+		}
+	}
+
+	void writeChunk(size_t channel)
+	{
+		Channel& c = _channels[channel];
+
+		CaptureIndexEntry entry;
+		entry.chunk.magic = CAPTURE_CHUNK_MAGIC;
+		entry.chunk.channel = channel;
+		entry.chunk.numSamples = c.samples.size();
+		entry.chunk.reserved = 0;
+		entry.chunk.firstTimeNs = c.firstTimeNs;
+		entry.chunk.lastTimeNs = c.lastTimeNs;
+
+		writeBytes(&entry.chunk, sizeof(entry.chunk));
+		entry.offset = ftello(_file);
+		writeBytes(&c.samples[0], c.samples.size() * sizeof(double));
+		_index.push_back(entry);
+
+		c.samples.clear();
+	}
+};
+
+
+/**
+ * Reads a capture file, and replays the samples of all channels in time order.
+ */
+class CaptureReader {
+public:
+	CaptureReader() :
+		_file(0),
+		_hasIndex(false),
+		_numSamples(0),
+		_durationNs(0)
+	{ }
+
+	~CaptureReader()
+	{
+		if (_file)
+		{
+			fclose(_file);
+		}
+	}
+
+	/**
+	 * Reads the header and the index (or rebuilds it, when missing)
+	 * @return false if the file could not be opened, or is not a capture file
+	 */
+	bool open(const std::string& fileName)
+	{
+		_file = fopen(fileName.c_str(), "rb");
+		if (!_file)
+		{
+			return false;
+		}
+
+		CaptureFileHeader header;
+		if (!readBytes(&header, sizeof(header)) ||
+			memcmp(header.magic, CAPTURE_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+			header.version != CAPTURE_FILE_VERSION)
+		{
+			return false;
+		}
+		for (uint32_t i = 0; i < header.numChannels; i++)
+		{
+			uint32_t length = 0;
+			if (!readBytes(&length, sizeof(length)) || length > 4096)
+			{
+				return false;
+			}
+			std::string name(length, ' ');
+			if (length && !readBytes(&name[0], length))
+			{
+				return false;
+			}
+			_channelNames.push_back(name);
+		}
+
+		const off_t firstChunk = ftello(_file);
+		_hasIndex = readIndex();
+		if (!_hasIndex)
+		{
+			scanChunks(firstChunk);
+		}
+
+		for (const auto& entry : _index)
+		{
+			_numSamples += entry.chunk.numSamples;
+			if (entry.chunk.lastTimeNs > _durationNs)
+			{
+				_durationNs = entry.chunk.lastTimeNs;
+			}
+		}
+		return true;
+	}
+
+	const std::vector<std::string>& getChannelNames() const { return _channelNames; }
+
+	/** Whether the file had an index (false for an unfinished recording) */
+	bool hasIndex() const { return _hasIndex; }
+
+	uint64_t getNumSamples() const { return _numSamples; }
+
+	int64_t getDurationNs() const { return _durationNs; }
+
+	/**
+	 * Calls fn(channel, value, timeNs) for every sample, in time order
+	 * (ties in channel order). Stops early if fn returns false.
+	 * @return false if stopped early or on read errors
+	 */
+	template<class Fn>
+	bool replay(Fn& fn)
+	{
+		// The chunks of each channel, in order, and where we are in them
+		std::vector<Cursor> cursors(_channelNames.size());
+		for (size_t i = 0; i < _index.size(); i++)
+		{
+			cursors[_index[i].chunk.channel].chunks.push_back(i);
+		}
+		for (auto& cursor : cursors)
+		{
+			if (!load(cursor))
+			{
+				return false;
+			}
+		}
+
+		while (true)
+		{
+			Cursor* next = 0;
+			size_t nextChannel = 0;
+			int64_t nextTime = 0;
+			for (size_t channel = 0; channel < cursors.size(); channel++)
+			{
+				Cursor& cursor = cursors[channel];
+				if (cursor.sample < cursor.samples.size() && (!next || cursor.time() < nextTime))
+				{
+					next = &cursor;
+					nextChannel = channel;
+					nextTime = cursor.time();
+				}
+			}
+			if (!next)
+			{
+				return true;
+			}
+
+			if (!fn(nextChannel, next->samples[next->sample], nextTime))
+			{
+				return false;
+			}
+
+			if (++next->sample == next->samples.size() && !load(*next))
+			{
+				return false;
+			}
+		}
+	}
+
+private:
+	struct Cursor {
+		std::vector<size_t> chunks;
+		size_t nextChunk;
+		std::vector<double> samples;
+		size_t sample;
+		int64_t firstTimeNs;
+		int64_t lastTimeNs;
+
+		Cursor() : nextChunk(0), sample(0), firstTimeNs(0), lastTimeNs(0)
+		{ }
+
+		int64_t time() const
+		{
+			if (samples.size() < 2)
+			{
+				return firstTimeNs;
+			}
+			return firstTimeNs + (lastTimeNs - firstTimeNs) * int64_t(sample) / int64_t(samples.size() - 1);
+		}
+	};
+
+	FILE* _file;
+	std::vector<std::string> _channelNames;
+	std::vector<CaptureIndexEntry> _index;
+	bool _hasIndex;
+	uint64_t _numSamples;
+	int64_t _durationNs;
+
+	bool readBytes(void* data, size_t size)
+	{
+		return fread(data, size, 1, _file) == 1;
+	}
+
+	/** Loads the next chunk of a channel (if any) */
+	bool load(Cursor& cursor)
+	{
+		cursor.samples.clear();
+		cursor.sample = 0;
+		if (cursor.nextChunk == cursor.chunks.size())
+		{
+			return true;
+		}
+
+		const CaptureIndexEntry& entry = _index[cursor.chunks[cursor.nextChunk++]];
+		cursor.samples.resize(entry.chunk.numSamples);
+		cursor.firstTimeNs = entry.chunk.firstTimeNs;
+		cursor.lastTimeNs = entry.chunk.lastTimeNs;
+		return fseeko(_file, entry.offset, SEEK_SET) == 0 &&
+				(cursor.samples.empty() || readBytes(&cursor.samples[0], cursor.samples.size() * sizeof(double)));
+	}
+
+	bool readIndex()
+	{
+		CaptureFileFooter footer;
+		if (fseeko(_file, -off_t(sizeof(footer)), SEEK_END) != 0 ||
+			!readBytes(&footer, sizeof(footer)) ||
+			footer.magic != CAPTURE_INDEX_MAGIC)
+		{
+			return false;
+		}
+
+		_index.resize(footer.numChunks);
+		if (fseeko(_file, footer.indexOffset, SEEK_SET) != 0 ||
+			(footer.numChunks && !readBytes(&_index[0], footer.numChunks * sizeof(_index[0]))))
+		{
+			_index.clear();
+			return false;
+		}
+		for (const auto& entry : _index)
+		{
+			if (entry.chunk.channel >= _channelNames.size())
+			{
+				_index.clear();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/** Rebuilds the index from the chunks, up to the first incomplete one */
+	void scanChunks(off_t offset)
+	{
+		_index.clear();
+		fseeko(_file, 0, SEEK_END);
+		const off_t end = ftello(_file);
+
+		CaptureIndexEntry entry;
+		while (fseeko(_file, offset, SEEK_SET) == 0 && readBytes(&entry.chunk, sizeof(entry.chunk)))
+		{
+			entry.offset = offset + sizeof(entry.chunk);
+			off_t chunkEnd = entry.offset + off_t(entry.chunk.numSamples) * sizeof(double);
+			if (entry.chunk.magic != CAPTURE_CHUNK_MAGIC ||
+				entry.chunk.channel >= _channelNames.size() ||
+				chunkEnd > end)
+			{
+				break;
+			}
+			_index.push_back(entry);
+			offset = chunkEnd;
+		}
+	}
+};
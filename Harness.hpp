@@ -0,0 +1,140 @@
+/*
+ * Harness.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Counters for finding the maximum sustained input rate (--harness).
+ *
+ * Ingest counters may be updated by several ingest threads (and are relaxed
+ * atomics for that), frame counters only by the display thread.
+ * printSummary() is meant to be called once all of them are done.
+ */
+class Harness {
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	Harness() :
+		_start(Clock::now()),
+		_bytesRead(0),
+		_linesRead(0),
+		_samplesAccepted(0),
+		_samplesDropped(0),
+		_samplesBlocked(0),
+		_blockedNs(0),
+		_backlogProbes(0),
+		_backlogSum(0),
+		_backlogMax(0),
+		_numFrames(0),
+		_frameTimeSum(0),
+		_frameTimeMin(Clock::duration::max()),
+		_frameTimeMax(0)
+	{ }
+
+	void lineRead(size_t bytes)
+	{
+		add(_bytesRead, bytes);
+		add(_linesRead, 1);
+	}
+
+	void samplesAccepted(size_t n) { add(_samplesAccepted, n); }
+
+	void samplesDropped(size_t n) { add(_samplesDropped, n); }
+
+	/** A sample had to wait for the lock of its channel */
+	void sampleBlocked(Clock::duration waited)
+	{
+		add(_samplesBlocked, 1);
+		add(_blockedNs, std::chrono::duration_cast<std::chrono::nanoseconds>(waited).count());
+	}
+
+	/** Bytes waiting in the input pipe, i.e. the writer is ahead of us */
+	void inputBacklog(size_t bytes)
+	{
+		add(_backlogProbes, 1);
+		add(_backlogSum, bytes);
+		uint64_t max = _backlogMax.load(std::memory_order_relaxed);
+		while (bytes > max && !_backlogMax.compare_exchange_weak(max, bytes, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	void frameRendered(Clock::duration renderTime)
+	{
+		_numFrames++;
+		_frameTimeSum += renderTime;
+		if (renderTime < _frameTimeMin) { _frameTimeMin = renderTime; }
+		if (renderTime > _frameTimeMax) { _frameTimeMax = renderTime; }
+	}
+
+	void printSummary(FILE* f) const
+	{
+		double seconds = toSeconds(Clock::now() - _start);
+
+		fprintf(f, "Harness summary after %.3f s\n", seconds);
+		const uint64_t bytesRead = _bytesRead;
+		const uint64_t samplesAccepted = _samplesAccepted;
+		const uint64_t backlogProbes = _backlogProbes;
+
+		fprintf(f, "  input:    %llu lines, %llu bytes (%.1f MB/s)\n",
+				(unsigned long long)_linesRead, (unsigned long long)bytesRead,
+				bytesRead / seconds / 1e6);
+		fprintf(f, "  accepted: %llu samples (%.0f samples/s)\n",
+				(unsigned long long)samplesAccepted, samplesAccepted / seconds);
+		fprintf(f, "  dropped:  %llu samples\n",
+				(unsigned long long)_samplesDropped);
+		fprintf(f, "  blocked:  %llu samples waited for the lock of their channel, %.3f s in total\n",
+				(unsigned long long)_samplesBlocked, _blockedNs / 1e9);
+		if (backlogProbes)
+		{
+			fprintf(f, "  backlog:  %.0f bytes average, %llu bytes max waiting in the input pipe\n",
+					double(_backlogSum) / backlogProbes, (unsigned long long)_backlogMax);
+		}
+		if (_numFrames)
+		{
+			fprintf(f, "  frames:   %llu, render time min/avg/max %.3f/%.3f/%.3f ms\n",
+					(unsigned long long)_numFrames,
+					1000 * toSeconds(_frameTimeMin),
+					1000 * toSeconds(_frameTimeSum) / _numFrames,
+					1000 * toSeconds(_frameTimeMax));
+		}
+	}
+
+private:
+	Clock::time_point _start;
+	std::atomic<uint64_t> _bytesRead;
+	std::atomic<uint64_t> _linesRead;
+	std::atomic<uint64_t> _samplesAccepted;
+	std::atomic<uint64_t> _samplesDropped;
+	std::atomic<uint64_t> _samplesBlocked;
+	std::atomic<uint64_t> _blockedNs;
+	std::atomic<uint64_t> _backlogProbes;
+	std::atomic<uint64_t> _backlogSum;
+	std::atomic<uint64_t> _backlogMax;
+	uint64_t _numFrames;
+	Clock::duration _frameTimeSum;
+	Clock::duration _frameTimeMin;
+	Clock::duration _frameTimeMax;
+
+	static void add(std::atomic<uint64_t>& counter, uint64_t n)
+	{
+		counter.fetch_add(n, std::memory_order_relaxed);
+	}
+
+	static double toSeconds(Clock::duration d)
+	{
+		return std::chrono::duration<double>(d).count();
+	}
+};
@@ -0,0 +1,61 @@
+/*
+ * IWindow.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+#include <SDL/SDL.h>
+
+/**
+ * Drawing surface used by the display thread.
+ *
+ * Implemented by SDLWindow (live video device) and OffscreenWindow
+ * (in-memory framebuffer, no display needed).
+ */
+class IWindow {
+public:
+	virtual ~IWindow() {};
+
+	virtual int getWidth() = 0;
+	virtual int getHeight() = 0;
+
+	virtual bool isFullscreen() = 0;
+	virtual void setFullscreenMode(bool shouldGoFullscreen = true) = 0;
+
+	/**
+	 * Reallocates the frame buffer at a new size (in windowed mode), but
+	 * not below a minimum size. The content is cleared.
+	 */
+	virtual void resize(int w, int h) = 0;
+
+	/**
+	 * Clears the frame being drawn, but does NOT flip buffers
+	 */
+	virtual void clear() = 0;
+
+	virtual void drawString(int x, int y, const char* s) = 0;
+
+	virtual void drawLine(Sint16 x1, Sint16 y1,
+			Sint16 x2, Sint16 y2,
+			Uint8 r, Uint8 g, Uint8 b, Uint8 a) = 0;
+
+	/**
+	 * Draws a w x h image of 0x00RRGGBB pixels with its top left corner at
+	 * (x, y). Black (0) pixels are treated as transparent.
+	 */
+	virtual void drawImage(int x, int y, int w, int h, const Uint32* rgb) = 0;
+
+	/**
+	 * Presents the frame drawn since the last clear()
+	 */
+	virtual void flip() = 0;
+
+protected:
+	// Smallest size resize() goes to, leaving room for the axis labels and the top text
+	enum { _min_width = 160, _min_height = 80 };
+};
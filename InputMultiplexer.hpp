@@ -0,0 +1,423 @@
+/*
+ * InputMultiplexer.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+
+/**
+ * Reads several inputs (files, FIFOs, stdin, Unix domain sockets, and UDP
+ * and TCP ports) from one thread, using epoll and non blocking reads of up
+ * to readSize bytes.
+ *
+ * Each input (source) gives one or more streams of data. A TCP port gives
+ * one stream per accepted connection, the others a single stream. UDP
+ * datagrams are received in batches with recvmmsg(), and each one is
+ * handed over separately.
+ *
+ * Regular files can not be waited for with epoll, so they are treated as
+ * always readable (and read in turn with the others until their end).
+ */
+class InputMultiplexer {
+public:
+	explicit InputMultiplexer(size_t readSize = 1 << 20) :
+		_epollFd(epoll_create1(EPOLL_CLOEXEC)),
+		_buffer(readSize),
+		_numOpen(0),
+		_numAlwaysReady(0)
+	{ }
+
+	~InputMultiplexer()
+	{
+		for (auto& stream : _streams)
+		{
+			if (stream.fd >= 0)
+			{
+				close(stream.fd);
+			}
+		}
+		if (_epollFd >= 0)
+		{
+			close(_epollFd);
+		}
+	}
+
+	/**
+	 * Opens an input:
+	 *  - "-" or "/dev/stdin" for stdin
+	 *  - "unix:PATH" to connect to a Unix domain stream socket
+	 *  - "udp:[HOST:]PORT" to receive datagrams on a port
+	 *  - "tcp:[HOST:]PORT" to accept connections on a port
+	 *  - otherwise the path of a file or FIFO
+	 * HOST defaults to all interfaces.
+	 * @return index of the source, or -1 (with errno set) on failure
+	 */
+	int addSource(const std::string& spec)
+	{
+		int fd = -1;
+		Kind kind = READ;
+		if (spec == "-" || spec == "/dev/stdin")
+		{
+			// A file description of our own, so making it non blocking
+			// doesn't affect whoever else shares stdin (falling back to
+			// sharing it for sockets, which can't be reopened)
+			fd = open("/proc/self/fd/0", O_RDONLY | O_CLOEXEC);
+			if (fd < 0)
+			{
+				fd = dup(0);
+			}
+		}
+		else if (spec.compare(0, 5, "unix:") == 0)
+		{
+			fd = connectUnix(spec.substr(5));
+		}
+		else if (spec.compare(0, 4, "udp:") == 0)
+		{
+			fd = bindInet(spec.substr(4), SOCK_DGRAM);
+			kind = DATAGRAM;
+		}
+		else if (spec.compare(0, 4, "tcp:") == 0)
+		{
+			fd = bindInet(spec.substr(4), SOCK_STREAM);
+			kind = LISTEN;
+			if (fd >= 0 && listen(fd, 16) != 0)
+			{
+				closeKeepingErrno(fd);
+				fd = -1;
+			}
+		}
+		else
+		{
+			// Opening a FIFO waits for a writer (as reading it with
+			// std::ifstream always did). Non blocking, it would look finished.
+			fd = open(spec.c_str(), O_RDONLY | O_CLOEXEC);
+		}
+		if (fd < 0)
+		{
+			return -1;
+		}
+
+		Source source;
+		source.name = spec;
+		source.isDatagram = (kind == DATAGRAM);
+		_sources.push_back(source);
+
+		if (!addStream(_sources.size() - 1, fd, kind))
+		{
+			closeKeepingErrno(fd);
+			_sources.pop_back();
+			return -1;
+		}
+		return _sources.size() - 1;
+	}
+
+	size_t getNumSources() const { return _sources.size(); }
+
+	const std::string& getName(size_t source) const { return _sources[source].name; }
+
+	/** Whether each read of the source is a datagram of its own */
+	bool isDatagram(size_t source) const { return _sources[source].isDatagram; }
+
+	/** Number of streams not yet at their end (listening sockets never end) */
+	size_t getNumOpen() const { return _numOpen; }
+
+	/**
+	 * Waits at most timeoutMs for input, then reads what is available.
+	 * Calls fn(source, stream, data, size) for each read, and
+	 * fn(source, stream, 0, 0) when a stream ends (or fails). fn may modify
+	 * the data (in place), which is only valid until it returns.
+	 * Stream numbers are never reused.
+	 * @return false when all streams have ended
+	 */
+	template<class Fn>
+	bool read(Fn& fn, int timeoutMs)
+	{
+		if (_numOpen == 0)
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < _streams.size() && _numAlwaysReady; i++)
+		{
+			if (_streams[i].kind == ALWAYS_READY && _streams[i].fd >= 0)
+			{
+				readStream(i, fn);
+			}
+		}
+
+		if (_numOpen > _numAlwaysReady)
+		{
+			struct epoll_event events[16];
+			int numEvents = epoll_wait(_epollFd, events, 16, _numAlwaysReady ? 0 : timeoutMs);
+			for (int i = 0; i < numEvents; i++)
+			{
+				size_t stream = events[i].data.u64;
+				switch (_streams[stream].kind)
+				{
+				case LISTEN:
+					acceptConnections(stream);
+					break;
+				case DATAGRAM:
+					receiveDatagrams(stream, fn);
+					break;
+				default:
+					readStream(stream, fn);
+					break;
+				}
+			}
+		}
+		return _numOpen > 0;
+	}
+
+	/** Bytes waiting in pipes, FIFOs and sockets (not counting regular files) */
+	size_t getPendingBytes() const
+	{
+		size_t pending = 0;
+		for (const auto& stream : _streams)
+		{
+			int bytes = 0;
+			if (stream.fd >= 0 && stream.kind != ALWAYS_READY && stream.kind != LISTEN &&
+				ioctl(stream.fd, FIONREAD, &bytes) == 0)
+			{
+				pending += bytes;
+			}
+		}
+		return pending;
+	}
+
+private:
+	enum Kind {
+		READ,          // pipes, FIFOs, stream sockets, ...
+		ALWAYS_READY,  // regular files
+		LISTEN,        // accepts new READ streams
+		DATAGRAM,
+	};
+
+	// Datagrams received per recvmmsg() call
+	enum { DATAGRAM_BATCH = 32, MAX_DATAGRAM_SIZE = 65536 };
+
+	struct Source {
+		std::string name;
+		bool isDatagram;
+	};
+
+	struct Stream {
+		size_t source;
+		int fd;
+		Kind kind;
+	};
+
+	int _epollFd;
+	std::vector<Source> _sources;
+	std::vector<Stream> _streams;
+	std::vector<char> _buffer;
+	std::vector<char> _datagramBuffer;
+	size_t _numOpen;
+	size_t _numAlwaysReady;
+
+	bool addStream(size_t source, int fd, Kind kind)
+	{
+		int flags = fcntl(fd, F_GETFL);
+		fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+		struct epoll_event event;
+		memset(&event, 0, sizeof(event));
+		event.events = EPOLLIN;
+		event.data.u64 = _streams.size();
+		if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &event) != 0)
+		{
+			if (errno != EPERM || kind != READ)
+			{
+				return false;
+			}
+			// A regular file (epoll has nothing to wait for)
+			kind = ALWAYS_READY;
+			_numAlwaysReady++;
+		}
+
+		Stream stream;
+		stream.source = source;
+		stream.fd = fd;
+		stream.kind = kind;
+		_streams.push_back(stream);
+		_numOpen++;
+		return true;
+	}
+
+	template<class Fn>
+	void readStream(size_t index, Fn& fn)
+	{
+		Stream& stream = _streams[index];
+		if (stream.fd < 0)
+		{
+			return;
+		}
+
+		ssize_t size = ::read(stream.fd, &_buffer[0], _buffer.size());
+		if (size > 0)
+		{
+			fn(stream.source, index, &_buffer[0], size_t(size));
+			return;
+		}
+		if (size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+		{
+			return;
+		}
+
+		// End of input, or an error
+		if (stream.kind == ALWAYS_READY)
+		{
+			_numAlwaysReady--;
+		}
+		else
+		{
+			epoll_ctl(_epollFd, EPOLL_CTL_DEL, stream.fd, 0);
+		}
+		close(stream.fd);
+		stream.fd = -1;
+		_numOpen--;
+		fn(stream.source, index, (char*)0, size_t(0));
+	}
+
+	template<class Fn>
+	void receiveDatagrams(size_t index, Fn& fn)
+	{
+		if (_datagramBuffer.empty())
+		{
+			_datagramBuffer.resize(DATAGRAM_BATCH * MAX_DATAGRAM_SIZE);
+		}
+
+		struct iovec iov[DATAGRAM_BATCH];
+		struct mmsghdr messages[DATAGRAM_BATCH];
+		memset(messages, 0, sizeof(messages));
+		for (int i = 0; i < DATAGRAM_BATCH; i++)
+		{
+			iov[i].iov_base = &_datagramBuffer[i * MAX_DATAGRAM_SIZE];
+			iov[i].iov_len = MAX_DATAGRAM_SIZE;
+			messages[i].msg_hdr.msg_iov = &iov[i];
+			messages[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		const Stream& stream = _streams[index];
+		int numMessages = recvmmsg(stream.fd, messages, DATAGRAM_BATCH, MSG_DONTWAIT, 0);
+		for (int i = 0; i < numMessages; i++)
+		{
+			fn(stream.source, index, &_datagramBuffer[i * MAX_DATAGRAM_SIZE], size_t(messages[i].msg_len));
+		}
+	}
+
+	void acceptConnections(size_t index)
+	{
+		// addStream() may reallocate _streams
+		const int listenFd = _streams[index].fd;
+		const size_t source = _streams[index].source;
+
+		int fd;
+		while ((fd = accept4(listenFd, 0, 0, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+		{
+			if (!addStream(source, fd, READ))
+			{
+				close(fd);
+			}
+		}
+	}
+
+	static void closeKeepingErrno(int fd)
+	{
+		int error = errno;
+		close(fd);
+		errno = error;
+	}
+
+	static int connectUnix(const std::string& path)
+	{
+		struct sockaddr_un address;
+		memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		if (path.size() >= sizeof(address.sun_path))
+		{
+			errno = ENAMETOOLONG;
+			return -1;
+		}
+		strcpy(address.sun_path, path.c_str());
+
+		int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (fd < 0)
+		{
+			return -1;
+		}
+		if (connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0)
+		{
+			closeKeepingErrno(fd);
+			return -1;
+		}
+		return fd;
+	}
+
+	/**
+	 * Creates a socket bound to "[HOST:]PORT"
+	 */
+	static int bindInet(const std::string& address, int type)
+	{
+		std::string host;
+		std::string port = address;
+		size_t colon = address.rfind(':');
+		if (colon != address.npos)
+		{
+			host = address.substr(0, colon);
+			port = address.substr(colon + 1);
+		}
+
+		struct addrinfo hints;
+		memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = type;
+		hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+
+		struct addrinfo* result = 0;
+		if (getaddrinfo(host.empty() ? 0 : host.c_str(), port.c_str(), &hints, &result) != 0 || !result)
+		{
+			errno = EINVAL;
+			return -1;
+		}
+
+		int fd = socket(result->ai_family, type | SOCK_CLOEXEC, 0);
+		if (fd >= 0)
+		{
+			int one = 1;
+			setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+			if (type == SOCK_DGRAM)
+			{
+				// Room for bursts while the reader is busy (best effort)
+				int size = 4 << 20;
+				setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+			}
+			if (bind(fd, result->ai_addr, result->ai_addrlen) != 0)
+			{
+				closeKeepingErrno(fd);
+				fd = -1;
+			}
+		}
+		freeaddrinfo(result);
+		return fd;
+	}
+};
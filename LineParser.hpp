@@ -0,0 +1,510 @@
+/*
+ * LineParser.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * Finds the -y prefixes in lines of input, and parses the number following them.
+ *
+ * A line containing several prefixes gives one sample per prefix.
+ * The number is expected right after the prefix, which should include
+ * everything from the start of the line.
+ *
+ * Lines are given as a pointer and a length, and need to be followed by a
+ * '\0' (as LineSplitter and std::string make sure of), which ends the
+ * number of a line ending in one.
+ */
+class PrefixMatcher {
+public:
+	void addPrefix(const std::string& prefix, size_t channel)
+	{
+		_prefixes.push_back(Prefix(prefix, channel));
+	}
+
+	size_t size() const { return _prefixes.size(); }
+
+	/**
+	 * Calls handler(channel, value) for each prefix found in line
+	 */
+	template<class Handler>
+	void match(const char* line, size_t size, Handler& handler) const
+	{
+		for (const auto& prefix : _prefixes)
+		{
+			if (contains(line, size, prefix.text))
+			{
+				handler(prefix.channel, parseNumber(line + prefix.text.size()));
+			}
+		}
+	}
+
+	template<class Handler>
+	void match(const std::string& line, Handler& handler) const
+	{
+		match(line.c_str(), line.size(), handler);
+	}
+
+	/**
+	 * Parses the number at the start of s (as atof does)
+	 */
+	static double parseNumber(const char* s)
+	{
+		return atof(s);
+	}
+
+private:
+	/**
+	 * Whether text is found in line. Lines and prefixes are short, so
+	 * looking for the first character with memchr beats memmem().
+	 */
+	static bool contains(const char* line, size_t size, const std::string& text)
+	{
+		if (text.empty())
+		{
+			return true;
+		}
+		const char* end = line + size;
+		const char* s = line;
+		while (size_t(end - s) >= text.size())
+		{
+			s = (const char*)memchr(s, text[0], end - s - text.size() + 1);
+			if (!s)
+			{
+				return false;
+			}
+			if (memcmp(s + 1, text.data() + 1, text.size() - 1) == 0)
+			{
+				return true;
+			}
+			s++;
+		}
+		return false;
+	}
+
+	struct Prefix {
+		std::string text;
+		size_t channel;
+		Prefix(const std::string& text, size_t channel) : text(text), channel(channel)
+		{ }
+	};
+	std::vector<Prefix> _prefixes;
+};
+
+
+/**
+ * Picks numbers out of selected columns of lines (--columns), such as
+ * "t,a,b,c" rows written by a logger.
+ *
+ * Each line is walked once, from the start to the last selected column.
+ * Columns are separated by the delimiter, or by runs of spaces and tabs
+ * when the delimiter is 0. Fields not starting with a number (a header
+ * line, an empty field, ...) give no sample.
+ *
+ * As with PrefixMatcher, a line needs to be followed by a '\0'.
+ */
+class ColumnParser {
+public:
+	explicit ColumnParser(char delimiter = 0) :
+		_delimiter(delimiter)
+	{ }
+
+	/**
+	 * @param column counting from 0
+	 */
+	void addColumn(size_t column, size_t channel)
+	{
+		if (column >= _channelOfColumn.size())
+		{
+			_channelOfColumn.resize(column + 1, size_t(NO_CHANNEL));
+		}
+		_channelOfColumn[column] = channel;
+	}
+
+	bool empty() const { return _channelOfColumn.empty(); }
+
+	/**
+	 * Calls handler(channel, value) for each selected column found in line
+	 */
+	template<class Handler>
+	void parse(const char* line, size_t size, Handler& handler) const
+	{
+		const char* s = line;
+		const char* end = s + size;
+		if (_delimiter == 0)
+		{
+			s = skipBlanks(s, end);
+		}
+
+		for (size_t column = 0; column < _channelOfColumn.size() && s <= end; column++)
+		{
+			const char* fieldEnd = findFieldEnd(s, end);
+			if (_channelOfColumn[column] != NO_CHANNEL && s < fieldEnd)
+			{
+				// strtod() skips leading blanks, and so would take the number
+				// of the next field for a field of only blanks
+				char* numberEnd = 0;
+				double value = strtod(s, &numberEnd);
+				if (numberEnd != s && numberEnd <= fieldEnd)
+				{
+					handler(_channelOfColumn[column], value);
+				}
+			}
+			s = (_delimiter == 0) ? skipBlanks(fieldEnd, end) : fieldEnd + 1;
+			if (_delimiter == 0 && s == end)
+			{
+				break;
+			}
+		}
+	}
+
+	template<class Handler>
+	void parse(const std::string& line, Handler& handler) const
+	{
+		parse(line.c_str(), line.size(), handler);
+	}
+
+	/**
+	 * Parses a list of columns (counting from 1) such as "2,3,5" or "2-4,7"
+	 * @return columns counting from 0, or nothing if list is malformed
+	 */
+	static std::vector<size_t> parseColumnList(const std::string& list)
+	{
+		std::vector<size_t> columns;
+		const char* s = list.c_str();
+		while (true)
+		{
+			char* end = 0;
+			long first = strtol(s, &end, 10);
+			long last = first;
+			if (end != s && *end == '-')
+			{
+				s = end + 1;
+				last = strtol(s, &end, 10);
+			}
+			if (end == s || first < 1 || last < first || (*end != ',' && *end != 0))
+			{
+				return std::vector<size_t>();
+			}
+			for (long column = first; column <= last; column++)
+			{
+				columns.push_back(column - 1);
+			}
+			if (*end == 0)
+			{
+				return columns;
+			}
+			s = end + 1;
+		}
+	}
+
+private:
+	static const size_t NO_CHANNEL = size_t(-1);
+
+	char _delimiter;
+	std::vector<size_t> _channelOfColumn; // NO_CHANNEL for columns not shown
+
+	const char* findFieldEnd(const char* s, const char* end) const
+	{
+		if (_delimiter != 0)
+		{
+			const char* delimiter = (const char*)memchr(s, _delimiter, end - s);
+			return delimiter ? delimiter : end;
+		}
+		while (s < end && *s != ' ' && *s != '\t')
+		{
+			s++;
+		}
+		return s;
+	}
+
+	static const char* skipBlanks(const char* s, const char* end)
+	{
+		while (s < end && (*s == ' ' || *s == '\t'))
+		{
+			s++;
+		}
+		return s;
+	}
+};
+
+
+/**
+ * Finds key=value pairs in lines (--auto), such as "y=0.5" or
+ * "t=12 a=1.5,b=-3", and gives the channel of each key.
+ *
+ * Keys are looked up in an open addressing hash table (FNV-1a of the key
+ * bytes, in the line itself), so finding the channel doesn't depend on
+ * the number of keys. Unknown keys are handed to newKey(), which may
+ * create a channel. Its answer is remembered (also when it is NO_CHANNEL),
+ * so it is asked only once per key: for maxKeys keys in the table, and
+ * for as many more in a slower overflow map. Keys beyond those are
+ * ignored without asking.
+ *
+ * As with PrefixMatcher, a line needs to be followed by a '\0'.
+ */
+class KeyValueParser {
+public:
+	static const size_t NO_CHANNEL = size_t(-1);
+
+	explicit KeyValueParser(size_t maxKeys = 1024) :
+		_maxKeys(maxKeys),
+		_numKeys(0),
+		_slots(16)
+	{ }
+
+	/** Adds (or changes) the channel of key */
+	void addKey(const std::string& key, size_t channel)
+	{
+		const uint64_t h = hash(key.data(), key.size());
+		Slot* slot = find(key.data(), key.size(), h);
+		if (slot->used)
+		{
+			slot->channel = channel;
+			return;
+		}
+		if (2 * (_numKeys + 1) > _slots.size())
+		{
+			grow();
+			slot = find(key.data(), key.size(), h);
+		}
+		slot->used = true;
+		slot->hash = h;
+		slot->key = key;
+		slot->channel = channel;
+		_numKeys++;
+	}
+
+	size_t getNumKeys() const { return _numKeys; }
+
+	/**
+	 * Calls handler(channel, value) for each key=value pair of a known (or
+	 * newly created) channel in line
+	 * @param newKey called as newKey(key) for keys not seen before, returning
+	 *        their channel (or NO_CHANNEL)
+	 */
+	template<class Handler, class NewKey>
+	void parse(const char* line, size_t size, Handler& handler, NewKey& newKey)
+	{
+		const char* s = line;
+		const char* end = s + size;
+		while (s < end)
+		{
+			while (s < end && isSeparator(*s))
+			{
+				s++;
+			}
+			const char* key = s;
+			while (s < end && *s != '=' && !isSeparator(*s))
+			{
+				s++;
+			}
+			if (s == end || *s != '=' || s == key)
+			{
+				s = skipField(s, end); // Not a key=value field
+				continue;
+			}
+			const size_t keyLength = s - key;
+
+			// The number directly after the '=' (strtod would skip blanks)
+			char* numberEnd = 0;
+			double value = 0;
+			if (s + 1 < end && !isSeparator(s[1]))
+			{
+				value = strtod(s + 1, &numberEnd);
+			}
+			if (!numberEnd || numberEnd == s + 1)
+			{
+				s = skipField(s, end);
+				continue;
+			}
+			s = numberEnd;
+
+			const uint64_t h = hash(key, keyLength);
+			const Slot* slot = find(key, keyLength, h);
+			size_t channel = slot->channel;
+			if (!slot->used)
+			{
+				channel = unknownKey(key, keyLength, newKey);
+			}
+			if (channel != NO_CHANNEL)
+			{
+				handler(channel, value);
+			}
+		}
+	}
+
+	template<class Handler, class NewKey>
+	void parse(const std::string& line, Handler& handler, NewKey& newKey)
+	{
+		parse(line.c_str(), line.size(), handler, newKey);
+	}
+
+	/** 64 bit FNV-1a */
+	static uint64_t hash(const char* s, size_t length)
+	{
+		uint64_t h = 14695981039346656037ULL;
+		for (size_t i = 0; i < length; i++)
+		{
+			h = (h ^ (unsigned char)s[i]) * 1099511628211ULL;
+		}
+		return h;
+	}
+
+private:
+	struct Slot {
+		Slot() : used(false), hash(0), channel(NO_CHANNEL)
+		{ }
+		bool used;
+		uint64_t hash;
+		std::string key;
+		size_t channel;
+	};
+
+	size_t _maxKeys;
+	size_t _numKeys;
+	std::vector<Slot> _slots; // A power of two of them, at most half used
+	std::unordered_map<std::string, size_t> _overflow; // Keys seen once the slots were full
+
+	/** The channel of a key not in the table, asking newKey only the first time */
+	template<class NewKey>
+	size_t unknownKey(const char* key, size_t length, NewKey& newKey)
+	{
+		const std::string name(key, length);
+		if (_numKeys < _maxKeys)
+		{
+			const size_t channel = newKey(name);
+			addKey(name, channel);
+			return channel;
+		}
+
+		auto found = _overflow.find(name);
+		if (found != _overflow.end())
+		{
+			return found->second;
+		}
+		if (_overflow.size() == _maxKeys)
+		{
+			return NO_CHANNEL;
+		}
+		const size_t channel = newKey(name);
+		_overflow[name] = channel;
+		return channel;
+	}
+
+	static bool isSeparator(char c)
+	{
+		return c == ' ' || c == '\t' || c == ',' || c == ';' || c == '\r';
+	}
+
+	static const char* skipField(const char* s, const char* end)
+	{
+		while (s < end && !isSeparator(*s))
+		{
+			s++;
+		}
+		return s;
+	}
+
+	/** The slot of key, or the empty slot where it would go */
+	Slot* find(const char* key, size_t length, uint64_t h)
+	{
+		const size_t mask = _slots.size() - 1;
+		for (size_t i = h & mask; ; i = (i + 1) & mask)
+		{
+			Slot& slot = _slots[i];
+			if (!slot.used ||
+				(slot.hash == h && slot.key.size() == length && memcmp(slot.key.data(), key, length) == 0))
+			{
+				return &slot;
+			}
+		}
+	}
+
+	void grow()
+	{
+		std::vector<Slot> old(_slots.size() * 2);
+		old.swap(_slots);
+		for (auto& slot : old)
+		{
+			if (slot.used)
+			{
+				Slot* to = find(slot.key.data(), slot.key.size(), slot.hash);
+				*to = slot;
+			}
+		}
+	}
+};
+
+
+/**
+ * Splits chunks of input (as read from a file descriptor) into lines.
+ *
+ * Lines are handed over where they are in the chunk, with the newline
+ * replaced by a '\0' (so the parsers above can stop at it). Only a line
+ * split over several chunks is copied, and kept until its end arrives.
+ */
+class LineSplitter {
+public:
+	/**
+	 * Calls fn(line, size) for each line completed by data (which is
+	 * modified, and needs to stay valid until fn returns)
+	 */
+	template<class Fn>
+	void push(char* data, size_t size, Fn& fn)
+	{
+		char* end = data + size;
+		while (data < end)
+		{
+			char* newline = (char*)memchr(data, '\n', end - data);
+			if (!newline)
+			{
+				_partial.append(data, end);
+				return;
+			}
+
+			if (_partial.empty())
+			{
+				*newline = '\0';
+				fn((const char*)data, size_t(newline - data));
+			}
+			else
+			{
+				_partial.append(data, newline);
+				fn(_partial.c_str(), _partial.size());
+				_partial.clear();
+			}
+			data = newline + 1;
+		}
+	}
+
+	/**
+	 * Calls fn(line, size) for what is left of an unterminated last line (if anything)
+	 */
+	template<class Fn>
+	void finish(Fn& fn)
+	{
+		if (!_partial.empty())
+		{
+			fn(_partial.c_str(), _partial.size());
+			_partial.clear();
+		}
+	}
+
+private:
+	std::string _partial;
+};
@@ -0,0 +1,97 @@
+/*
+ * MemoryBudget.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+#include <string>
+
+#include <stdlib.h>
+
+/**
+ * Memory limit for the waveform storages (--memory-limit).
+ *
+ * At startup it gives the number of points each storage can keep. While
+ * running, the caller accounts what is actually allocated with setUsed(),
+ * and shrinks the storages when the limit is exceeded.
+ */
+class MemoryBudget {
+public:
+	/**
+	 * @param limit in bytes, or 0 for no limit
+	 */
+	explicit MemoryBudget(size_t limit = 0) :
+		_limit(limit),
+		_used(0)
+	{ }
+
+	bool isLimited() const { return _limit != 0; }
+
+	size_t getLimit() const { return _limit; }
+
+	/**
+	 * Number of points each of numChannels storages can keep, when every
+	 * point takes bytesPerPoint (counting all copies of it), and each
+	 * channel also needs fixedBytesPerChannel. Rounded down to an even number.
+	 * @return 0 if there is not room for two points per channel
+	 */
+	size_t pointsPerChannel(size_t numChannels, size_t bytesPerPoint, size_t fixedBytesPerChannel) const
+	{
+		if (numChannels == 0 || bytesPerPoint == 0 || numChannels * fixedBytesPerChannel >= _limit)
+		{
+			return 0;
+		}
+		size_t points = (_limit - numChannels * fixedBytesPerChannel) / numChannels / bytesPerPoint;
+		return points & ~size_t(1);
+	}
+
+	/** Bytes in use, as accounted by the caller */
+	void setUsed(size_t bytes) { _used = bytes; }
+
+	size_t getUsed() const { return _used; }
+
+	bool isExceeded() const { return isLimited() && _used > _limit; }
+
+	/**
+	 * Parses sizes such as 512M, 2G, 64k or 1000000 (bytes). K, M and G are
+	 * powers of 1024, in either case.
+	 * @return false if text is not a size
+	 */
+	static bool parseSize(const std::string& text, size_t& bytes)
+	{
+		const char* s = text.c_str();
+		char* end = 0;
+		unsigned long long value = strtoull(s, &end, 10);
+		if (end == s || *s == '-')
+		{
+			return false;
+		}
+
+		int shift = 0;
+		switch (*end)
+		{
+		case 'k': case 'K': shift = 10; end++; break;
+		case 'm': case 'M': shift = 20; end++; break;
+		case 'g': case 'G': shift = 30; end++; break;
+		}
+		if (*end == 'B' || *end == 'b')
+		{
+			end++;
+		}
+		if (*end != 0 || value > (~0ULL >> shift) || ((value << shift) > size_t(-1)))
+		{
+			return false;
+		}
+		bytes = size_t(value << shift);
+		return true;
+	}
+
+private:
+	size_t _limit;
+	size_t _used;
+};
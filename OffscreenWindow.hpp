@@ -0,0 +1,184 @@
+/*
+ * OffscreenWindow.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+#include "IWindow.hpp"
+
+#include <SDL/SDL.h>
+#include <SDL/SDL_gfxPrimitives.h>
+
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * Renders into an in-memory software surface. Does not need an X server
+ * or any SDL video device, since SDL_gfx can draw on any SDL_Surface.
+ *
+ * Every dumpInterval:th flipped frame is optionally written to disk as
+ * a binary PPM file named <dumpPrefix><frame number>.ppm
+ */
+class OffscreenWindow : public IWindow {
+public:
+	OffscreenWindow(int w = 800, int h = 510) :
+		_w(w),
+		_h(h),
+		_screen(0),
+		_numFlippedFrames(0),
+		_dumpInterval(0)
+	{
+		allocateSurface();
+	}
+
+	~OffscreenWindow()
+	{
+		SDL_FreeSurface(_screen);
+		_screen = 0;
+	}
+
+	/**
+	 * @param prefix       Path prefix of written frames (e.g. "/tmp/frame_")
+	 * @param dumpInterval Write every dumpInterval:th frame. 0 disables dumping.
+	 */
+	void setFrameDump(const std::string& prefix, int dumpInterval)
+	{
+		_dumpPrefix = prefix;
+		_dumpInterval = dumpInterval;
+	}
+
+	int getWidth() { return _w; }
+
+	int getHeight() { return _h; }
+
+	bool isFullscreen() { return false; }
+
+	void setFullscreenMode(bool shouldGoFullscreen = true)
+	{
+		// Nothing to switch to without a display
+	}
+
+	void resize(int w, int h)
+	{
+		if (w < _min_width) { w = _min_width; }
+		if (h < _min_height) { h = _min_height; }
+
+		SDL_FreeSurface(_screen);
+		_w = w;
+		_h = h;
+		allocateSurface();
+	}
+
+	void clear()
+	{
+		memset(_screen->pixels, 0, _screen->pitch*_h);
+	}
+
+	void drawString(int x, int y, const char* s)
+	{
+		stringRGBA(_screen, x, y, s, 255, 255, 255, 255);
+	}
+
+	void drawLine(Sint16 x1, Sint16 y1,
+			Sint16 x2, Sint16 y2,
+			Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+	{
+		lineRGBA(_screen, x1, y1, x2, y2, r, g, b, a);
+	}
+
+	void drawImage(int x, int y, int w, int h, const Uint32* rgb)
+	{
+		for (int row = 0; row < h; row++)
+		{
+			if (y + row < 0 || y + row >= _h)
+			{
+				continue;
+			}
+			Uint32* pixels = (Uint32*)((Uint8*)_screen->pixels + (y + row)*_screen->pitch);
+			for (int col = 0; col < w; col++)
+			{
+				Uint32 color = rgb[row * w + col];
+				if (color && x + col >= 0 && x + col < _w)
+				{
+					pixels[x + col] = color;
+				}
+			}
+		}
+	}
+
+	void flip()
+	{
+		if (_dumpInterval > 0 && (_numFlippedFrames % _dumpInterval) == 0)
+		{
+			char buffer[32];
+			snprintf(buffer, sizeof(buffer), "%06lu.ppm", (unsigned long)_numFlippedFrames);
+			writePPM(_dumpPrefix + buffer);
+		}
+		_numFlippedFrames++;
+	}
+
+	size_t getNumFlippedFrames() const { return _numFlippedFrames; }
+
+	/**
+	 * Writes the current frame as a binary (P6) PPM file
+	 * @return false if the file could not be written
+	 */
+	bool writePPM(const std::string& fileName)
+	{
+		FILE* f = fopen(fileName.c_str(), "wb");
+		if (!f)
+		{
+			printf("Unable to write frame to \"%s\"\n", fileName.c_str());
+			return false;
+		}
+
+		fprintf(f, "P6\n%d %d\n255\n", _w, _h);
+
+		std::vector<Uint8> row(_w * 3);
+		for (int y = 0; y < _h; y++)
+		{
+			const Uint32* pixels = (const Uint32*)((const Uint8*)_screen->pixels + y*_screen->pitch);
+			for (int x = 0; x < _w; x++)
+			{
+				row[3*x + 0] = (pixels[x] >> 16) & 0xff;
+				row[3*x + 1] = (pixels[x] >> 8) & 0xff;
+				row[3*x + 2] = pixels[x] & 0xff;
+			}
+			fwrite(&row[0], 1, row.size(), f);
+		}
+
+		bool ok = (ferror(f) == 0);
+		fclose(f);
+		return ok;
+	}
+
+private:
+	int _w;
+	int _h;
+	SDL_Surface *_screen;
+	size_t _numFlippedFrames;
+	int _dumpInterval;
+	std::string _dumpPrefix;
+
+	void allocateSurface()
+	{
+		_screen = SDL_CreateRGBSurface(SDL_SWSURFACE, _w, _h, 32,
+				0x00ff0000, 0x0000ff00, 0x000000ff, 0);
+		if ( _screen == NULL )
+		{
+			printf("Unable to create %dx%d offscreen surface: %s\n", _w, _h, SDL_GetError());
+			exit(1);
+		}
+		clear();
+	}
+};
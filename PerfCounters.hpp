@@ -0,0 +1,303 @@
+/*
+ * PerfCounters.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+
+/**
+ * Counters behind the live performance statistics (--stats and the overlay).
+ *
+ * Every thread updates a block of counters of its own, so counting is a
+ * relaxed load and store, without locks or cache lines shared with other
+ * threads. read() sums up the blocks of all threads. The sums may lag
+ * slightly behind, but a counter is never torn.
+ */
+class PerfCounters {
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	enum Counter {
+		LINES,         ///< input lines (or binary frames) parsed
+		TIMED_LINES,   ///< the lines of those parsed while timing was enabled
+		PARSE_NS,      ///< time parsing and storing the timed lines
+		LOCK_WAITS,    ///< samples that had to wait for the lock of their channel
+		LOCK_WAIT_NS,
+		DEFERRED,      ///< samples held back instead of waiting for the lock (--overload)
+		DROPPED,       ///< samples lost to the overload policy
+		DECIMATED,     ///< samples removed by reducing held samples to min/max
+		FRAMES,
+		FRAME_NS,
+		SNAPSHOTS,     ///< copies of the waveforms taken for drawing
+		SNAPSHOT_NS,
+		NUM_COUNTERS
+	};
+
+	/** Number of per channel sample counters. Set before anything is counted */
+	static void setNumChannels(size_t numChannels) { shared().numChannels = numChannels; }
+
+	/** Per line timing is only done when enabled, as reading the clock is not free */
+	static void setEnabled(bool enabled) { shared().enabled.store(enabled, std::memory_order_relaxed); }
+
+	static bool isEnabled() { return shared().enabled.load(std::memory_order_relaxed); }
+
+	static void add(Counter counter, uint64_t n = 1) { local().add(counter, n); }
+
+	static void addTime(Counter counter, Clock::duration d)
+	{
+		add(counter, std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+	}
+
+	static void addSamples(size_t channel, uint64_t n = 1) { local().add(NUM_COUNTERS + channel, n); }
+
+	struct Snapshot {
+		Clock::time_point time;
+		std::vector<uint64_t> counters; // NUM_COUNTERS, followed by one per channel
+
+		uint64_t get(Counter counter) const { return counters[counter]; }
+		size_t getNumChannels() const { return counters.size() - NUM_COUNTERS; }
+		uint64_t getSamples(size_t channel) const { return counters[NUM_COUNTERS + channel]; }
+	};
+
+	static Snapshot read()
+	{
+		Shared& s = shared();
+		Snapshot snapshot;
+		snapshot.counters.resize(NUM_COUNTERS + s.numChannels, 0);
+
+		std::lock_guard<std::mutex> guard(s.mutex);
+		snapshot.time = Clock::now();
+		for (const auto& block : s.blocks)
+		{
+			block->addTo(snapshot.counters);
+		}
+		return snapshot;
+	}
+
+private:
+	class Block {
+	public:
+		explicit Block(size_t size) :
+			_size(size),
+			_storage(new std::atomic<uint64_t>[size + 2 * PADDING]),
+			_counters(_storage.get() + PADDING)
+		{
+			for (size_t i = 0; i < size + 2 * PADDING; i++)
+			{
+				_storage[i].store(0, std::memory_order_relaxed);
+			}
+		}
+
+		/** Only to be called by the owning thread */
+		void add(size_t i, uint64_t n)
+		{
+			if (i < _size)
+			{
+				_counters[i].store(_counters[i].load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+			}
+		}
+
+		void addTo(std::vector<uint64_t>& sums) const
+		{
+			for (size_t i = 0; i < _size && i < sums.size(); i++)
+			{
+				sums[i] += _counters[i].load(std::memory_order_relaxed);
+			}
+		}
+
+	private:
+		// Keeps the counters of different threads on different cache lines
+		enum { PADDING = 64 / sizeof(uint64_t) };
+
+		size_t _size;
+		std::unique_ptr<std::atomic<uint64_t>[]> _storage;
+		std::atomic<uint64_t>* _counters;
+	};
+
+	struct Shared {
+		Shared() : numChannels(0), enabled(false)
+		{ }
+		std::mutex mutex;
+		std::vector<std::unique_ptr<Block> > blocks; // Kept after their threads exit
+		size_t numChannels;
+		std::atomic<bool> enabled;
+	};
+
+	static Shared& shared()
+	{
+		static Shared s;
+		return s;
+	}
+
+	static Block& local()
+	{
+		static thread_local Block* block = 0;
+		if (!block)
+		{
+			Shared& s = shared();
+			std::lock_guard<std::mutex> guard(s.mutex);
+			s.blocks.push_back(std::unique_ptr<Block>(new Block(NUM_COUNTERS + s.numChannels)));
+			block = s.blocks.back().get();
+		}
+		return *block;
+	}
+};
+
+
+/**
+ * Turns PerfCounters into rates over the last interval, formatted as text
+ * lines for the overlay and --stats.
+ */
+class PerfReport {
+public:
+	typedef PerfCounters::Clock Clock;
+
+	PerfReport(const std::vector<std::string>& channelNames,
+			Clock::duration interval = std::chrono::seconds(1)) :
+		_channelNames(channelNames),
+		_interval(interval),
+		_last(PerfCounters::read()),
+		_accountedBytes(0),
+		_memoryLimit(0)
+	{
+		_lines.push_back("stats: collecting...");
+	}
+
+	/**
+	 * Recalculates the lines if the interval has passed since the last time.
+	 * @return true if the lines were updated
+	 */
+	bool update()
+	{
+		if (Clock::now() - _last.time < _interval)
+		{
+			return false;
+		}
+
+		PerfCounters::Snapshot now = PerfCounters::read();
+		const double seconds = std::chrono::duration<double>(now.time - _last.time).count();
+		const auto & delta = [&](PerfCounters::Counter counter) {
+			return double(now.get(counter) - _last.get(counter));
+		};
+		const auto & perItem = [](double total, double items) {
+			return items > 0 ? total / items : 0.0;
+		};
+
+		_lines.clear();
+		char buffer[200];
+
+		double totalSamples = 0;
+		for (size_t channel = 0; channel < now.getNumChannels(); channel++)
+		{
+			totalSamples += now.getSamples(channel) - _last.getSamples(channel);
+		}
+		snprintf(buffer, sizeof(buffer), "ingest:   %.0f samples/s, %.0f lines/s",
+				totalSamples / seconds, delta(PerfCounters::LINES) / seconds);
+		_lines.push_back(buffer);
+
+		// Counted channels beyond those named are not in use (yet)
+		for (size_t channel = 0; channel < now.getNumChannels() && channel < _channelNames.size(); channel++)
+		{
+			snprintf(buffer, sizeof(buffer), "  %-16s %.0f samples/s",
+					_channelNames[channel].c_str(),
+					(now.getSamples(channel) - _last.getSamples(channel)) / seconds);
+			_lines.push_back(buffer);
+		}
+
+		snprintf(buffer, sizeof(buffer), "parse:    %.0f ns/line (including storing)",
+				perItem(delta(PerfCounters::PARSE_NS), delta(PerfCounters::TIMED_LINES)));
+		_lines.push_back(buffer);
+
+		snprintf(buffer, sizeof(buffer), "lock:     %.0f waits/s, %.3f ms waited/s",
+				delta(PerfCounters::LOCK_WAITS) / seconds, delta(PerfCounters::LOCK_WAIT_NS) / 1e6 / seconds);
+		_lines.push_back(buffer);
+
+		snprintf(buffer, sizeof(buffer), "overload: %.0f deferred/s, %.0f dropped/s, %.0f decimated/s",
+				delta(PerfCounters::DEFERRED) / seconds, delta(PerfCounters::DROPPED) / seconds,
+				delta(PerfCounters::DECIMATED) / seconds);
+		_lines.push_back(buffer);
+
+		snprintf(buffer, sizeof(buffer), "frame:    %.1f frames/s, %.3f ms/frame",
+				delta(PerfCounters::FRAMES) / seconds,
+				perItem(delta(PerfCounters::FRAME_NS), delta(PerfCounters::FRAMES)) / 1e6);
+		_lines.push_back(buffer);
+
+		snprintf(buffer, sizeof(buffer), "snapshot: %.3f ms/copy",
+				perItem(delta(PerfCounters::SNAPSHOT_NS), delta(PerfCounters::SNAPSHOTS)) / 1e6);
+		_lines.push_back(buffer);
+
+		if (_memoryLimit)
+		{
+			snprintf(buffer, sizeof(buffer), "memory:   %.1f MB resident, %.1f of %.1f MB accounted",
+					residentBytes() / 1e6, _accountedBytes / 1e6, _memoryLimit / 1e6);
+		}
+		else
+		{
+			snprintf(buffer, sizeof(buffer), "memory:   %.1f MB resident", residentBytes() / 1e6);
+		}
+		_lines.push_back(buffer);
+
+		_last = now;
+		return true;
+	}
+
+	const std::vector<std::string>& getLines() const { return _lines; }
+
+	/** For channels added while running */
+	void setChannelNames(const std::vector<std::string>& channelNames) { _channelNames = channelNames; }
+
+	/** Shown from the next update() on, as accounted for --memory-limit */
+	void setAccountedMemory(size_t bytes, size_t limit)
+	{
+		_accountedBytes = bytes;
+		_memoryLimit = limit;
+	}
+
+	void print(FILE* f) const
+	{
+		for (const auto& line : _lines)
+		{
+			fprintf(f, "%s\n", line.c_str());
+		}
+		fprintf(f, "\n");
+	}
+
+	/** Resident set size of the process, from /proc/self/statm (0 if unknown) */
+	static size_t residentBytes()
+	{
+		long size = 0, resident = 0;
+		FILE* f = fopen("/proc/self/statm", "r");
+		if (f)
+		{
+			if (fscanf(f, "%ld %ld", &size, &resident) != 2)
+			{
+				resident = 0;
+			}
+			fclose(f);
+		}
+		return size_t(resident) * sysconf(_SC_PAGESIZE);
+	}
+
+private:
+	std::vector<std::string> _channelNames;
+	Clock::duration _interval;
+	PerfCounters::Snapshot _last;
+	std::vector<std::string> _lines;
+	size_t _accountedBytes;
+	size_t _memoryLimit;
+};
@@ -14,9 +14,16 @@
 
 class SDLEventHandler {
 public:
-	SDLEventHandler() :
+	explicit SDLEventHandler(bool showStats = false) :
 		_should_quit(false),
-		_should_go_fullscreen(false)
+		_should_go_fullscreen(false),
+		_should_show_stats(showStats),
+		_should_show_channel_stats(true),
+		_latency_dump_requested(false),
+		_export_requested(false),
+		_resize_requested(false),
+		_requested_w(0),
+		_requested_h(0)
 	{
 		refresh();
 	}
@@ -44,6 +51,22 @@ public:
 					_should_go_fullscreen ^= true;
 					break;
 
+				case SDLK_s:
+					_should_show_stats ^= true;
+					break;
+
+				case SDLK_c:
+					_should_show_channel_stats ^= true;
+					break;
+
+				case SDLK_l:
+					_latency_dump_requested = true;
+					break;
+
+				case SDLK_e:
+					_export_requested = true;
+					break;
+
 				case SDLK_SPACE:
 					break;
 				default:
@@ -62,11 +85,10 @@ public:
 
 			if (event.type == SDL_VIDEORESIZE)
 			{
-				int w = event.resize.w;
-				int h = event.resize.h;
-				std::cout
-				<< "Resize events not supported. (resize to "
-				<< w << "x" << h << " requested)\n";
+				// Only the last of several queued resize events matters
+				_resize_requested = true;
+				_requested_w = event.resize.w;
+				_requested_h = event.resize.h;
 			}
 		}
 	}
@@ -75,8 +97,50 @@ public:
 
 	bool shouldGoFullscreen() const { return _should_go_fullscreen; }
 
+	bool shouldShowStats() const { return _should_show_stats; }
+
+	bool shouldShowChannelStats() const { return _should_show_channel_stats; }
+
+	/** Returns true (once) if L was pressed since the last call */
+	bool getLatencyDumpRequest()
+	{
+		bool requested = _latency_dump_requested;
+		_latency_dump_requested = false;
+		return requested;
+	}
+
+	/** Returns true (once) if E was pressed since the last call */
+	bool getExportRequest()
+	{
+		bool requested = _export_requested;
+		_export_requested = false;
+		return requested;
+	}
+
+	/**
+	 * Returns true (once) if the window was resized by the user since the
+	 * last call, and then sets w and h to the requested size.
+	 */
+	bool getResizeRequest(int& w, int& h)
+	{
+		if (!_resize_requested)
+		{
+			return false;
+		}
+		_resize_requested = false;
+		w = _requested_w;
+		h = _requested_h;
+		return true;
+	}
 
 private:
 	bool _should_quit;
 	bool _should_go_fullscreen;
+	bool _should_show_stats;
+	bool _should_show_channel_stats;
+	bool _latency_dump_requested;
+	bool _export_requested;
+	bool _resize_requested;
+	int _requested_w;
+	int _requested_h;
 };
@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include "IWindow.hpp"
+
 #include <SDL/SDL.h>
 #include <SDL/SDL_gfxPrimitives.h>
 #include <SDL/SDL_gfxPrimitives_font.h>
@@ -17,7 +19,7 @@
 
 #include <assert.h>
 
-class SDLWindow {
+class SDLWindow : public IWindow {
 public:
 	SDLWindow() :
 		_should_call_sdl_quit(true),
@@ -52,7 +54,7 @@ public:
 			_h = _smallSizeHeight = _fullscreenHeight - 12; // 12 is just a guess of the height of the window managers title bar
 		}
 
-		_screen = SDL_SetVideoMode(_w, _h, 32, SDL_HWSURFACE/*|SDL_DOUBLEBUF*/);
+		_screen = SDL_SetVideoMode(_w, _h, 32, SDL_HWSURFACE | SDL_RESIZABLE/*|SDL_DOUBLEBUF*/);
 		if ( _screen == NULL )
 		{
 			printf("Unable to set %dx%d video: %s\n", _w, _h, SDL_GetError());
@@ -87,7 +89,7 @@ public:
 		{
 			_w = _smallSizeWidth;
 			_h = _smallSizeHeight;
-			flags = SDL_HWSURFACE /*|SDL_DOUBLEBUF*/;
+			flags = SDL_HWSURFACE | SDL_RESIZABLE /*|SDL_DOUBLEBUF*/;
 		}
 
 //		printf("Requested: %dx%d\n", _w, _h);
@@ -101,6 +103,28 @@ public:
 		_isFullscreen = shouldGoFullscreen;
 	}
 
+	void resize(int w, int h)
+	{
+		if (_isFullscreen)
+		{
+			return;
+		}
+
+		if (w < _min_width) { w = _min_width; }
+		if (h < _min_height) { h = _min_height; }
+
+		_w = _smallSizeWidth = w;
+		_h = _smallSizeHeight = h;
+
+		_screen = SDL_SetVideoMode(_w, _h, 32, SDL_HWSURFACE | SDL_RESIZABLE /*|SDL_DOUBLEBUF*/);
+		if ( _screen == NULL )
+		{
+			printf("Unable to set %dx%d video: %s\n", _w, _h, SDL_GetError());
+			exit(1);
+		}
+		clear();
+	}
+
 	void blank()
 	{
 		clearInternalFramebuffer(_screen);
@@ -135,6 +159,23 @@ public:
 		lineRGBA(_screen, x1, y1, x2, y2, r, g, b, a);
 	}
 
+	void drawImage(int x, int y, int w, int h, const Uint32* rgb)
+	{
+		lock(_screen);
+		for (int row = 0; row < h; row++)
+		{
+			for (int col = 0; col < w; col++)
+			{
+				Uint32 color = rgb[row * w + col];
+				if (color)
+				{
+					safeDrawPixel(_screen, x + col, y + row, color >> 16, color >> 8, color);
+				}
+			}
+		}
+		unlock(_screen);
+	}
+
 	void flip()
 	{
 		SDL_Flip(_screen);
@@ -19,17 +19,30 @@
 #include <stdint.h>
 
 
+/**
+ * Keeps at most maxWaveformSize points, each the min and max of a number of
+ * samples that doubles every time the points run out.
+ *
+ * Halving the resolution is never done in one go: the half resolution points
+ * (pairs of points merged) are kept in a second vector, built up a couple of
+ * pairs per new point, and swapped in when the first one is full. So a push
+ * does a bounded amount of work however many points are kept. Both vectors
+ * have room for maxWaveformSize points, as they take turns being the kept one.
+ */
 template<class T>
-class CappedPeakStorageWaveform : public IWaveformStorage<T> {
+class CappedPeakStorageWaveform final : public IWaveformStorage<T> {
 public:
 	
 	CappedPeakStorageWaveform(int maxWaveformSize = 4096) :
 	_maxWaveformSize(maxWaveformSize),
 	_waveformNumSamplesSkip(0), // 0 = everysample, 1 = every other sample
-	_skipCounter(0)
+	_skipCounter(0),
+	_lastSample()
 	{
 		assert((_maxWaveformSize & 1) == 0); // Needs to be even
 		clear();
+		_waveform.reserve(_maxWaveformSize);
+		_halved.reserve(_maxWaveformSize);
 	}
 	
 	void push(T val)
@@ -38,30 +51,19 @@ public:
 		_lastSample = val;
 		if (_skipCounter == _waveformNumSamplesSkip)
 		{
-			if (_waveform.size() < _maxWaveformSize)
-			{
-				_waveform.push_back(_currentMinMax);
-				_currentMinMax.reset();
-				_skipCounter = 0;
-				return;
-			}
-			else
+			if (_waveform.size() >= _maxWaveformSize)
 			{
-				// Compact the vector to only use every second sample.
-				// double _waveformNumSamplesSkip,
-				for (size_t i = 0; 2*i < _maxWaveformSize; i++)
-				{
-					_waveform[i] = _waveform[2*i];
-				}
-				_waveform.resize(_maxWaveformSize/2);
-				_waveformNumSamplesSkip = (_waveformNumSamplesSkip + 1) * 2 - 1;
-
-				// Don't forget the current sample as well
-				_waveform.push_back(_currentMinMax);
-				_currentMinMax.reset();
-				_skipCounter = 0;
-				return;
+				swapInHalved();
 			}
+
+			_waveform.push_back(_currentMinMax);
+			_currentMinMax.reset();
+			_skipCounter = 0;
+
+			// Two pairs per point catches up with the pairs left after a
+			// swap before the points run out again
+			mergePairs(2);
+			return;
 		}
 
 		_skipCounter++;
@@ -77,28 +79,97 @@ public:
 
 	IWaveformStorage<T>* duplicate() const
 	{
-		CappedPeakStorageWaveform* w = new CappedPeakStorageWaveform(_maxWaveformSize);
-		w->_waveformNumSamplesSkip = _waveformNumSamplesSkip;
-		w->_skipCounter = _skipCounter;
-		w->_currentMinMax = _currentMinMax;
-		w->_waveform = _waveform;
-		w->_lastSample = _lastSample;
-		return w;
+		// Copying only allocates room for the points kept. The copy builds
+		// its own half resolution again if pushed to
+		return new CappedPeakStorageWaveform(*this, WithoutHalved());
 	}
 
 	void clear()
 	{
 		_waveform.clear();
+		_halved.clear();
 		_waveformNumSamplesSkip = 0;
 		_skipCounter = 0;
 		_currentMinMax.reset();
 	}
 
+	size_t memoryUsage() const
+	{
+		return (_waveform.capacity() + _halved.capacity()) * sizeof(_waveform[0]);
+	}
+
+	/**
+	 * Compacts until at most maxPoints (an even number) are kept
+	 */
+	void setCapacity(size_t maxPoints)
+	{
+		assert((maxPoints & 1) == 0 && maxPoints > 0);
+		_maxWaveformSize = maxPoints;
+		while (_waveform.size() > _maxWaveformSize)
+		{
+			mergePairs(_waveform.size());
+			swapInHalved();
+		}
+		std::vector<MinMax<T> > resized;
+		resized.reserve(_maxWaveformSize);
+		resized.assign(_waveform.begin(), _waveform.end());
+		_waveform.swap(resized);
+
+		std::vector<MinMax<T> > halved;
+		halved.reserve(_maxWaveformSize);
+		_halved.swap(halved);
+		mergePairs(_waveform.size());
+	}
+
 private:
 	size_t _maxWaveformSize;
 	size_t _waveformNumSamplesSkip;
 	size_t _skipCounter;
 	MinMax<T> _currentMinMax;
 	std::vector<MinMax<T> > _waveform;
+	std::vector<MinMax<T> > _halved; // _halved[i] is _waveform[2*i] and _waveform[2*i+1] merged
 	T _lastSample;
+
+	struct WithoutHalved {};
+
+	CappedPeakStorageWaveform(const CappedPeakStorageWaveform& other, WithoutHalved) :
+		_maxWaveformSize(other._maxWaveformSize),
+		_waveformNumSamplesSkip(other._waveformNumSamplesSkip),
+		_skipCounter(other._skipCounter),
+		_currentMinMax(other._currentMinMax),
+		_waveform(other._waveform),
+		_lastSample(other._lastSample)
+	{
+	}
+
+	/** Merges up to maxPairs of the pairs of points not yet in _halved */
+	void mergePairs(size_t maxPairs)
+	{
+		for (; maxPairs > 0 && 2 * _halved.size() + 1 < _waveform.size(); maxPairs--)
+		{
+			const size_t i = 2 * _halved.size();
+			MinMax<T> merged = _waveform[i];
+			merged.update(_waveform[i + 1].min);
+			merged.update(_waveform[i + 1].max);
+			_halved.push_back(merged);
+		}
+	}
+
+	/**
+	 * Makes the half resolution points the kept ones, and from now on keeps
+	 * twice as many samples per point. Only a trailing unpaired point (when
+	 * compacting to a smaller capacity) is carried over as is.
+	 */
+	void swapInHalved()
+	{
+		// Only left to do after setCapacity() or on a copy
+		mergePairs(_waveform.size());
+		if (_waveform.size() & 1)
+		{
+			_halved.push_back(_waveform.back());
+		}
+		_waveform.swap(_halved);
+		_halved.clear();
+		_waveformNumSamplesSkip = (_waveformNumSamplesSkip + 1) * 2 - 1;
+	}
 };
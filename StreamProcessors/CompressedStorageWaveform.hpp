@@ -0,0 +1,731 @@
+/*
+ * CompressedStorageWaveform.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+
+#include "IWaveformStorage.hpp"
+#include "MinMax.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+
+/**
+ * Appends bits to a vector of words, least significant bit first.
+ */
+class BitWriter {
+public:
+	BitWriter(std::vector<uint64_t>& words, uint64_t bitPosition) :
+		_words(words),
+		_bitPosition(bitPosition)
+	{ }
+
+	/** Writes the numBits (1 to 64) lowest bits of value */
+	void write(uint64_t value, int numBits)
+	{
+		if (numBits < 64)
+		{
+			value &= (uint64_t(1) << numBits) - 1;
+		}
+		size_t word = _bitPosition / 64;
+		int offset = _bitPosition % 64;
+		if (word + 1 >= _words.size())
+		{
+			_words.resize(word + 2, 0);
+		}
+		_words[word] |= value << offset;
+		if (offset && offset + numBits > 64)
+		{
+			_words[word + 1] |= value >> (64 - offset);
+		}
+		_bitPosition += numBits;
+	}
+
+	uint64_t getBitPosition() const { return _bitPosition; }
+
+private:
+	std::vector<uint64_t>& _words;
+	uint64_t _bitPosition;
+};
+
+
+/**
+ * Reads what BitWriter wrote.
+ */
+class BitReader {
+public:
+	BitReader(const uint64_t* words, uint64_t bitPosition) :
+		_words(words),
+		_bitPosition(bitPosition)
+	{ }
+
+	uint64_t read(int numBits)
+	{
+		size_t word = _bitPosition / 64;
+		int offset = _bitPosition % 64;
+		uint64_t value = _words[word] >> offset;
+		if (offset && offset + numBits > 64)
+		{
+			value |= _words[word + 1] << (64 - offset);
+		}
+		if (numBits < 64)
+		{
+			value &= (uint64_t(1) << numBits) - 1;
+		}
+		_bitPosition += numBits;
+		return value;
+	}
+
+private:
+	const uint64_t* _words;
+	uint64_t _bitPosition;
+};
+
+
+/**
+ * Keeps every sample (losslessly) in compressed blocks of BLOCK_SAMPLES
+ * samples, next to a min/max view of at most maxWaveformSize points.
+ *
+ * Each block is encoded in whichever of these ways is smallest:
+ *  - XOR: Gorilla style. Each value is XORed with the one before, and only
+ *    the bits between the leading and trailing zeros are kept (or a single
+ *    bit when equal).
+ *  - DELTA or DELTA_OF_DELTA: when every value of the block is an integer
+ *    divided by a power of ten (as printed numbers with a few decimals
+ *    are), exactly. The integers are stored as zig-zag encoded differences
+ *    (or differences of differences) in a few bit length classes.
+ *
+ * Every block carries its MinMax, so min/max over ranges of the history
+ * only decompresses the blocks at the ends. The view is fed as samples
+ * arrive. Each of its points covers twice as many samples whenever it
+ * fills up (merging pairs of points). Drawing (getColumns()) uses the view
+ * and the block MinMax only, so it never decompresses.
+ *
+ * Sealed blocks never change, and are shared by copies (duplicate()), so
+ * copying to draw or export only copies pointers to them.
+ *
+ * With a maxHistoryBytes limit, the oldest blocks are dropped to stay
+ * within it. Blocks are kept in a deque, so that is done without moving
+ * the rest. The view still covers all samples pushed.
+ *
+ * Values are encoded as doubles.
+ */
+template<class T>
+class CompressedStorageWaveform final : public IWaveformStorage<T> {
+public:
+	enum { BLOCK_SAMPLES = 1024 };
+
+	CompressedStorageWaveform(int maxWaveformSize = 4096, size_t maxHistoryBytes = 0) :
+		_maxWaveformSize(maxWaveformSize),
+		_maxHistoryBytes(maxHistoryBytes),
+		_lastSample(),
+		_isCopy(false)
+	{
+		assert((_maxWaveformSize & 1) == 0); // Needs to be even
+		clear();
+	}
+
+	void push(T val)
+	{
+		_lastSample = val;
+
+		if (_samplesInPoint == 0 && _view.size() == _maxWaveformSize)
+		{
+			mergeViewPoints();
+		}
+		_point.update(val);
+		if (++_samplesInPoint == _samplesPerPoint)
+		{
+			_view.push_back(_point);
+			_point.reset();
+			_samplesInPoint = 0;
+		}
+
+		_current.push_back(double(val));
+		if (_current.size() == BLOCK_SAMPLES)
+		{
+			sealBlock();
+		}
+	}
+
+	const std::vector<MinMax<T> >& getWaveform() const {
+		return _view;
+	}
+
+	const T getLastSample() const {
+		return _lastSample;
+	}
+
+	/**
+	 * A copy sharing the sealed blocks, so it costs the view, the samples
+	 * not yet sealed and a pointer per block
+	 */
+	IWaveformStorage<T>* duplicate() const
+	{
+		return new CompressedStorageWaveform(*this, SharedBlocks());
+	}
+
+	void clear()
+	{
+		_view.clear();
+		_point.reset();
+		_samplesPerPoint = 1;
+		_samplesInPoint = 0;
+		_blocks.clear();
+		_numWords = 0;
+		_current.clear();
+		_current.reserve(BLOCK_SAMPLES);
+		_numSealedSamples = 0;
+		_numDroppedSamples = 0;
+		_decodedFirstSample = NOT_DECODED;
+		_decoded.clear();
+	}
+
+	size_t memoryUsage() const
+	{
+		// Blocks shared with the original are counted there
+		return _view.capacity() * sizeof(_view[0]) +
+				(_isCopy ? _blocks.size() * sizeof(_blocks[0]) : getCompressedBytes()) +
+				_current.capacity() * sizeof(_current[0]);
+	}
+
+	/** Merges view points until at most maxPoints (an even number) are left */
+	void setCapacity(size_t maxPoints)
+	{
+		assert((maxPoints & 1) == 0 && maxPoints > 0);
+		_maxWaveformSize = maxPoints;
+		while (_view.size() > _maxWaveformSize)
+		{
+			mergeViewPoints();
+		}
+	}
+
+	/** Samples in the history (not counting dropped blocks) */
+	uint64_t getNumSamples() const { return _numSealedSamples + _current.size(); }
+
+	/** Samples pushed since clear(), whether still in the history or dropped */
+	uint64_t getTotalSamples() const { return _numDroppedSamples + getNumSamples(); }
+
+	/** Bytes used by the compressed blocks */
+	size_t getCompressedBytes() const
+	{
+		return _numWords * sizeof(uint64_t) + _blocks.size() * (sizeof(Block) + sizeof(_blocks[0]));
+	}
+
+	/**
+	 * Calls fn(value) for every sample in the history, oldest first
+	 */
+	template<class Fn>
+	void forEachSample(Fn& fn) const
+	{
+		forEachSample(0, getNumSamples(), fn);
+	}
+
+	/**
+	 * Calls fn(value) for count samples of the history, starting at first
+	 * (0 being the oldest kept)
+	 */
+	template<class Fn>
+	void forEachSample(uint64_t first, uint64_t count, Fn& fn) const
+	{
+		const uint64_t begin = first + _numDroppedSamples;
+		const uint64_t end = std::min(first + count, getNumSamples()) + _numDroppedSamples;
+		for (auto it = findBlock(begin); it != _blocks.end() && (*it)->firstSample < end; ++it)
+		{
+			const Block& block = **it;
+			const std::vector<double>& values = decoded(block);
+			const uint64_t blockEnd = std::min(end, block.firstSample + block.numSamples);
+			for (uint64_t j = std::max(begin, block.firstSample); j < blockEnd; j++)
+			{
+				fn(T(values[j - block.firstSample]));
+			}
+		}
+		const uint64_t currentStart = _numDroppedSamples + _numSealedSamples;
+		for (uint64_t j = std::max(begin, currentStart); j < end; j++)
+		{
+			fn(T(_current[j - currentStart]));
+		}
+	}
+
+	/**
+	 * Min and max of count samples of the history, starting at first (0
+	 * being the oldest kept). Only blocks partly in the range are decoded.
+	 */
+	MinMax<T> getMinMax(uint64_t first, uint64_t count) const
+	{
+		MinMax<T> result;
+		const uint64_t begin = first + _numDroppedSamples;
+		const uint64_t end = std::min(first + count, getNumSamples()) + _numDroppedSamples;
+		for (auto it = findBlock(begin); it != _blocks.end() && (*it)->firstSample < end; ++it)
+		{
+			const Block& block = **it;
+			const uint64_t blockEnd = block.firstSample + block.numSamples;
+			if (begin <= block.firstSample && blockEnd <= end)
+			{
+				result.update(block.minMax.min);
+				result.update(block.minMax.max);
+			}
+			else
+			{
+				const std::vector<double>& values = decoded(block);
+				for (uint64_t j = std::max(begin, block.firstSample); j < std::min(end, blockEnd); j++)
+				{
+					result.update(T(values[j - block.firstSample]));
+				}
+			}
+		}
+		const uint64_t currentStart = _numDroppedSamples + _numSealedSamples;
+		for (uint64_t j = std::max(begin, currentStart); j < end; j++)
+		{
+			result.update(T(_current[j - currentStart]));
+		}
+		return result;
+	}
+
+	/**
+	 * Min and max of each of numColumns equal parts of all samples pushed
+	 * (fewer columns when there are fewer samples), for drawing. Nothing is
+	 * decompressed: each column is made of whole view points, or (where
+	 * they cover fewer samples and the blocks are kept) whole blocks and
+	 * the samples not yet sealed. So columns may reach a little past their
+	 * part.
+	 */
+	void getColumns(size_t numColumns, std::vector<MinMax<T> >& columns) const
+	{
+		const uint64_t total = getTotalSamples();
+		const bool blocksAreFiner = _samplesPerPoint > BLOCK_SAMPLES;
+		numColumns = size_t(std::min<uint64_t>(numColumns, total));
+		columns.assign(numColumns, MinMax<T>());
+		for (size_t c = 0; c < numColumns; c++)
+		{
+			const uint64_t begin = c * total / numColumns;
+			const uint64_t end = (c + 1) * total / numColumns;
+			MinMax<T>& column = columns[c];
+
+			const uint64_t viewEnd = blocksAreFiner ? std::min(end, _numDroppedSamples) : end;
+			if (begin < viewEnd)
+			{
+				addViewPoints(begin, viewEnd, column);
+			}
+
+			const uint64_t blocksBegin = std::max(begin, viewEnd);
+			if (blocksBegin < end)
+			{
+				for (auto it = findBlock(blocksBegin); it != _blocks.end() && (*it)->firstSample < end; ++it)
+				{
+					column.update((*it)->minMax.min);
+					column.update((*it)->minMax.max);
+				}
+				const uint64_t currentStart = _numDroppedSamples + _numSealedSamples;
+				for (uint64_t j = std::max(blocksBegin, currentStart); j < end; j++)
+				{
+					column.update(T(_current[j - currentStart]));
+				}
+			}
+		}
+	}
+
+private:
+	enum Encoding { XOR, DELTA, DELTA_OF_DELTA };
+
+	// Largest power of ten tried for DELTA encodings
+	enum { MAX_DECIMALS = 9 };
+
+	static const uint64_t NOT_DECODED = uint64_t(-1);
+
+	struct Block {
+		std::vector<uint64_t> words;
+		uint64_t firstSample; // Counted from clear(), dropped samples included
+		uint32_t numSamples;
+		uint8_t encoding;
+		uint8_t decimals;
+		MinMax<T> minMax;
+	};
+
+	size_t _maxWaveformSize;
+	size_t _maxHistoryBytes;
+
+	std::vector<MinMax<T> > _view;
+	MinMax<T> _point;          // Being collected for the view
+	uint64_t _samplesPerPoint;
+	uint64_t _samplesInPoint;
+
+	std::deque<std::shared_ptr<const Block> > _blocks;
+	size_t _numWords;             // Of all blocks
+	std::vector<double> _current; // Not yet compressed
+	uint64_t _numSealedSamples;
+	uint64_t _numDroppedSamples;
+	std::vector<uint64_t> _scratch;
+	T _lastSample;
+	bool _isCopy; // Made by duplicate()
+
+	// The block last decoded (by firstSample), as ranges mostly come in order
+	mutable uint64_t _decodedFirstSample;
+	mutable std::vector<double> _decoded;
+
+	struct SharedBlocks {};
+
+	/** A copy sharing the blocks of other (and no room reserved for more) */
+	CompressedStorageWaveform(const CompressedStorageWaveform& other, SharedBlocks) :
+		_maxWaveformSize(other._maxWaveformSize),
+		_maxHistoryBytes(other._maxHistoryBytes),
+		_view(other._view),
+		_point(other._point),
+		_samplesPerPoint(other._samplesPerPoint),
+		_samplesInPoint(other._samplesInPoint),
+		_blocks(other._blocks),
+		_numWords(other._numWords),
+		_current(other._current),
+		_numSealedSamples(other._numSealedSamples),
+		_numDroppedSamples(other._numDroppedSamples),
+		_lastSample(other._lastSample),
+		_isCopy(true),
+		_decodedFirstSample(NOT_DECODED)
+	{
+	}
+
+	/** Adds the view points (and the one being collected) covering samples [begin, end) */
+	void addViewPoints(uint64_t begin, uint64_t end, MinMax<T>& column) const
+	{
+		uint64_t p = begin / _samplesPerPoint;
+		for (; p < _view.size() && p * _samplesPerPoint < end; p++)
+		{
+			column.update(_view[p].min);
+			column.update(_view[p].max);
+		}
+		if (p == _view.size() && p * _samplesPerPoint < end && _samplesInPoint > 0)
+		{
+			column.update(_point.min);
+			column.update(_point.max);
+		}
+	}
+
+	void mergeViewPoints()
+	{
+		for (size_t i = 0; 2*i < _view.size(); i++)
+		{
+			MinMax<T> merged = _view[2*i];
+			if (2*i + 1 < _view.size())
+			{
+				merged.update(_view[2*i + 1].min);
+				merged.update(_view[2*i + 1].max);
+			}
+			_view[i] = merged;
+		}
+		_view.resize((_view.size() + 1) / 2);
+		_samplesPerPoint *= 2;
+	}
+
+	static uint64_t toBits(double value)
+	{
+		uint64_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	static double fromBits(uint64_t bits)
+	{
+		double value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	static double powerOfTen(int decimals)
+	{
+		static const double powers[MAX_DECIMALS + 1] = { 1, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+		return powers[decimals];
+	}
+
+	static int64_t zigZagDecode(uint64_t u)
+	{
+		return int64_t(u >> 1) ^ -int64_t(u & 1);
+	}
+
+	static uint64_t zigZagEncode(int64_t v)
+	{
+		return (uint64_t(v) << 1) ^ uint64_t(v >> 63);
+	}
+
+	/**
+	 * The number of decimals (up to MAX_DECIMALS) making every value an
+	 * integer divided by a power of ten, exactly
+	 * @return false if there is none
+	 */
+	bool findDecimals(int& decimals) const
+	{
+		decimals = 0;
+		for (double value : _current)
+		{
+			while (decimals <= MAX_DECIMALS && !isScaledInteger(value, decimals))
+			{
+				decimals++;
+			}
+			if (decimals > MAX_DECIMALS)
+			{
+				return false;
+			}
+		}
+		// Fewer decimals giving an exact value does not imply more do
+		for (double value : _current)
+		{
+			if (!isScaledInteger(value, decimals))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static bool isScaledInteger(double value, int decimals)
+	{
+		// An integer has no -0, so that one is left to XOR
+		if (value == 0 && signbit(value))
+		{
+			return false;
+		}
+		double scaled = nearbyint(value * powerOfTen(decimals));
+		return fabs(scaled) < 9007199254740992.0 && // 2^53
+				toBits(scaled / powerOfTen(decimals)) == toBits(value);
+	}
+
+	/** Writes u in one of a few bit length classes */
+	static void writeClassified(BitWriter& writer, uint64_t u)
+	{
+		if (u == 0)
+		{
+			writer.write(0, 1);
+		}
+		else if (u < (uint64_t(1) << 6))
+		{
+			writer.write(0x1, 2); // 10
+			writer.write(u, 6);
+		}
+		else if (u < (uint64_t(1) << 13))
+		{
+			writer.write(0x3, 3); // 110
+			writer.write(u, 13);
+		}
+		else if (u < (uint64_t(1) << 20))
+		{
+			writer.write(0x7, 4); // 1110
+			writer.write(u, 20);
+		}
+		else
+		{
+			writer.write(0xf, 4); // 1111
+			writer.write(u, 64);
+		}
+	}
+
+	static uint64_t readClassified(BitReader& reader)
+	{
+		static const int numBits[] = { 0, 6, 13, 20, 64 };
+		int ones = 0;
+		while (ones < 4 && reader.read(1))
+		{
+			ones++;
+		}
+		return ones ? reader.read(numBits[ones]) : 0;
+	}
+
+	void encodeXor(BitWriter& writer) const
+	{
+		uint64_t previous = toBits(_current[0]);
+		writer.write(previous, 64);
+		int previousLeading = -1;
+		int previousTrailing = 0;
+		for (size_t i = 1; i < _current.size(); i++)
+		{
+			uint64_t bits = toBits(_current[i]);
+			uint64_t x = bits ^ previous;
+			previous = bits;
+			if (x == 0)
+			{
+				writer.write(0, 1);
+				continue;
+			}
+			writer.write(1, 1);
+
+			int leading = std::min(__builtin_clzll(x), 31);
+			int trailing = __builtin_ctzll(x);
+			if (previousLeading >= 0 && leading >= previousLeading && trailing >= previousTrailing)
+			{
+				// Fits the window of the value before
+				writer.write(0, 1);
+				writer.write(x >> previousTrailing, 64 - previousLeading - previousTrailing);
+			}
+			else
+			{
+				int meaningful = 64 - leading - trailing;
+				writer.write(1, 1);
+				writer.write(leading, 5);
+				writer.write(meaningful - 1, 6);
+				writer.write(x >> trailing, meaningful);
+				previousLeading = leading;
+				previousTrailing = trailing;
+			}
+		}
+	}
+
+	static void decodeXor(BitReader& reader, size_t numSamples, std::vector<double>& values)
+	{
+		uint64_t previous = reader.read(64);
+		values.push_back(fromBits(previous));
+		int leading = 0;
+		int trailing = 0;
+		for (size_t i = 1; i < numSamples; i++)
+		{
+			if (reader.read(1))
+			{
+				if (reader.read(1))
+				{
+					leading = int(reader.read(5));
+					int meaningful = int(reader.read(6)) + 1;
+					trailing = 64 - leading - meaningful;
+				}
+				previous ^= reader.read(64 - leading - trailing) << trailing;
+			}
+			values.push_back(fromBits(previous));
+		}
+	}
+
+	void encodeDelta(BitWriter& writer, int decimals, bool ofDelta) const
+	{
+		int64_t previous = int64_t(nearbyint(_current[0] * powerOfTen(decimals)));
+		int64_t previousDelta = 0;
+		writer.write(uint64_t(previous), 64);
+		for (size_t i = 1; i < _current.size(); i++)
+		{
+			int64_t value = int64_t(nearbyint(_current[i] * powerOfTen(decimals)));
+			int64_t delta = value - previous;
+			writeClassified(writer, zigZagEncode(ofDelta ? delta - previousDelta : delta));
+			previous = value;
+			previousDelta = delta;
+		}
+	}
+
+	static void decodeDelta(BitReader& reader, size_t numSamples, int decimals, bool ofDelta,
+			std::vector<double>& values)
+	{
+		int64_t value = int64_t(reader.read(64));
+		int64_t delta = 0;
+		values.push_back(value / powerOfTen(decimals));
+		for (size_t i = 1; i < numSamples; i++)
+		{
+			int64_t difference = zigZagDecode(readClassified(reader));
+			delta = ofDelta ? delta + difference : difference;
+			value += delta;
+			values.push_back(value / powerOfTen(decimals));
+		}
+	}
+
+	/** Compresses _current into a new block, with the smallest encoding */
+	void sealBlock()
+	{
+		if (_current.empty())
+		{
+			return;
+		}
+
+		std::shared_ptr<Block> block = std::make_shared<Block>();
+		block->firstSample = _numDroppedSamples + _numSealedSamples;
+		block->numSamples = _current.size();
+		block->decimals = 0;
+		for (double value : _current)
+		{
+			block->minMax.update(T(value));
+		}
+
+		_scratch.clear();
+		BitWriter xorWriter(_scratch, 0);
+		encodeXor(xorWriter);
+		uint64_t bestBits = xorWriter.getBitPosition();
+		block->encoding = XOR;
+
+		int decimals = 0;
+		if (findDecimals(decimals))
+		{
+			for (int ofDelta = 0; ofDelta < 2; ofDelta++)
+			{
+				std::vector<uint64_t> words;
+				BitWriter writer(words, 0);
+				encodeDelta(writer, decimals, ofDelta);
+				if (writer.getBitPosition() < bestBits)
+				{
+					bestBits = writer.getBitPosition();
+					block->encoding = ofDelta ? DELTA_OF_DELTA : DELTA;
+					block->decimals = decimals;
+					_scratch.swap(words);
+				}
+			}
+		}
+
+		block->words.assign(_scratch.begin(), _scratch.begin() + (bestBits + 63) / 64);
+		_numWords += block->words.size();
+		_blocks.push_back(block);
+		_numSealedSamples += _current.size();
+		_current.clear();
+
+		if (_maxHistoryBytes && getCompressedBytes() > _maxHistoryBytes)
+		{
+			dropOldestBlocks();
+		}
+	}
+
+	void decodeBlock(const Block& block, std::vector<double>& values) const
+	{
+		values.clear();
+		BitReader reader(&block.words[0], 0);
+		if (block.encoding == XOR)
+		{
+			decodeXor(reader, block.numSamples, values);
+		}
+		else
+		{
+			decodeDelta(reader, block.numSamples, block.decimals, block.encoding == DELTA_OF_DELTA, values);
+		}
+	}
+
+	/** Oldest block ending after sample (counted from clear()) */
+	typename std::deque<std::shared_ptr<const Block> >::const_iterator findBlock(uint64_t sample) const
+	{
+		return std::upper_bound(_blocks.begin(), _blocks.end(), sample,
+				[](uint64_t s, const std::shared_ptr<const Block>& block) { return s < block->firstSample + block->numSamples; });
+	}
+
+	/** The values of block, decoding it unless it was the last one decoded */
+	const std::vector<double>& decoded(const Block& block) const
+	{
+		if (_decodedFirstSample != block.firstSample)
+		{
+			decodeBlock(block, _decoded);
+			_decodedFirstSample = block.firstSample;
+		}
+		return _decoded;
+	}
+
+	void dropOldestBlocks()
+	{
+		while (!_blocks.empty() && getCompressedBytes() > _maxHistoryBytes)
+		{
+			_numWords -= _blocks.front()->words.size();
+			_numSealedSamples -= _blocks.front()->numSamples;
+			_numDroppedSamples += _blocks.front()->numSamples;
+			_blocks.pop_front();
+		}
+	}
+};
@@ -0,0 +1,123 @@
+/*
+ * FFT.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+#include <complex>
+#include <vector>
+
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * In place radix-2 fast Fourier transform of a fixed power of two size.
+ *
+ * The bit reversal permutation and the twiddle factors are computed once,
+ * with the twiddles of each stage stored after each other, so every stage
+ * reads them in order. With SSE2, a complex number fits one register and
+ * the butterflies are done on those.
+ */
+class FFT {
+public:
+	explicit FFT(size_t size) :
+		_size(size)
+	{
+		assert(isPowerOfTwo(size));
+
+		int bits = 0;
+		while ((size_t(1) << bits) < size)
+		{
+			bits++;
+		}
+		_reversed.resize(size);
+		for (size_t i = 0; i < size; i++)
+		{
+			size_t r = 0;
+			for (int b = 0; b < bits; b++)
+			{
+				r |= ((i >> b) & 1) << (bits - 1 - b);
+			}
+			_reversed[i] = r;
+		}
+
+		// Stage with butterflies spanning half: half twiddles e^(-i*pi*k/half)
+		for (size_t half = 1; half < size; half *= 2)
+		{
+			for (size_t k = 0; k < half; k++)
+			{
+				_twiddles.push_back(std::polar(1.0, -M_PI * k / half));
+			}
+		}
+	}
+
+	size_t getSize() const { return _size; }
+
+	/** Forward transform (without scaling) of getSize() values */
+	void transform(std::complex<double>* data) const
+	{
+		for (size_t i = 0; i < _size; i++)
+		{
+			if (i < _reversed[i])
+			{
+				std::swap(data[i], data[_reversed[i]]);
+			}
+		}
+
+		const std::complex<double>* twiddles = &_twiddles[0];
+		for (size_t half = 1; half < _size; half *= 2)
+		{
+			for (size_t start = 0; start < _size; start += 2 * half)
+			{
+				for (size_t k = 0; k < half; k++)
+				{
+					butterfly(data[start + k], data[start + k + half], twiddles[k]);
+				}
+			}
+			twiddles += half;
+		}
+	}
+
+	static bool isPowerOfTwo(size_t n)
+	{
+		return n >= 2 && (n & (n - 1)) == 0;
+	}
+
+private:
+	size_t _size;
+	std::vector<size_t> _reversed;
+	std::vector<std::complex<double> > _twiddles;
+
+	/** a, b = a + w * b, a - w * b */
+	static void butterfly(std::complex<double>& a, std::complex<double>& b, const std::complex<double>& w)
+	{
+#ifdef __SSE2__
+		// std::complex<double> is laid out as two doubles (real, imaginary)
+		double* pa = reinterpret_cast<double*>(&a);
+		double* pb = reinterpret_cast<double*>(&b);
+		const __m128d va = _mm_loadu_pd(pa);
+		const __m128d vb = _mm_loadu_pd(pb);
+		const __m128d swapped = _mm_shuffle_pd(vb, vb, 1);                   // (bi, br)
+		const __m128d wr = _mm_set1_pd(w.real());
+		const __m128d wi = _mm_set_pd(w.imag(), -w.imag());                // (-wi, wi)
+		const __m128d t = _mm_add_pd(_mm_mul_pd(wr, vb), _mm_mul_pd(wi, swapped));
+		_mm_storeu_pd(pa, _mm_add_pd(va, t));
+		_mm_storeu_pd(pb, _mm_sub_pd(va, t));
+#else
+		const std::complex<double> t(w.real() * b.real() - w.imag() * b.imag(),
+				w.real() * b.imag() + w.imag() * b.real());
+		b = a - t;
+		a += t;
+#endif
+	}
+};
@@ -20,21 +20,30 @@
 #include <stdint.h>
 
 
+/**
+ * Keeps the last maxWaveformSize samples.
+ *
+ * Up to twice that many are kept between calls to getWaveform(), so the
+ * oldest ones are dropped in bulk, instead of moving all the others for
+ * every new sample.
+ */
 template<class T>
-class FIFOStorageWaveform : public IWaveformStorage<T> {
+class FIFOStorageWaveform final : public IWaveformStorage<T> {
 public:
 	
 	FIFOStorageWaveform(int maxWaveformSize = 4096) :
-	_maxWaveformSize(maxWaveformSize)
+	_maxWaveformSize(maxWaveformSize),
+	_lastSample()
 	{
 		clear();
+		_waveform.reserve(2 * _maxWaveformSize);
 	}
 	
 	void push(T val)
 	{
-		if (_waveform.size() == _maxWaveformSize)
+		if (_waveform.size() == 2 * _maxWaveformSize)
 		{
-			_waveform.erase(_waveform.begin());
+			trim();
 		}
 
 		_waveform.push_back(MinMax<T>(val, val));
@@ -42,6 +51,7 @@ public:
 	}
 
 	const std::vector<MinMax<T> >& getWaveform() const {
+		trim();
 		return _waveform;
 	}
 
@@ -51,10 +61,9 @@ public:
 
 	IWaveformStorage<T>* duplicate() const
 	{
-		FIFOStorageWaveform* w = new FIFOStorageWaveform(_maxWaveformSize);
-		w->_waveform = _waveform;
-		w->_lastSample = _lastSample;
-		return w;
+		trim();
+		// Copying only allocates room for the points kept
+		return new FIFOStorageWaveform(*this);
 	}
 
 	void clear()
@@ -62,8 +71,32 @@ public:
 		_waveform.clear();
 	}
 
+	size_t memoryUsage() const
+	{
+		return _waveform.capacity() * sizeof(_waveform[0]);
+	}
+
+	void setCapacity(size_t maxPoints)
+	{
+		_maxWaveformSize = maxPoints;
+		trim();
+		std::vector<MinMax<T> > resized;
+		resized.reserve(2 * _maxWaveformSize);
+		resized.assign(_waveform.begin(), _waveform.end());
+		_waveform.swap(resized);
+	}
+
 private:
 	size_t _maxWaveformSize;
-	std::vector<MinMax<T> > _waveform; // TODO: Decide what to return. This class would prefer a std::deque, or iterators. Others would prefer std::vector
+	mutable std::vector<MinMax<T> > _waveform; // TODO: Decide what to return. This class would prefer a std::deque, or iterators. Others would prefer std::vector
 	T _lastSample;
+
+	/** Drops all but the last _maxWaveformSize points */
+	void trim() const
+	{
+		if (_waveform.size() > _maxWaveformSize)
+		{
+			_waveform.erase(_waveform.begin(), _waveform.end() - _maxWaveformSize);
+		}
+	}
 };
@@ -12,6 +12,7 @@
 #include "MinMax.hpp"
 
 #include <assert.h>
+#include <stddef.h>
 
 #include <vector>
 
@@ -29,4 +30,10 @@ public:
 
 	virtual IWaveformStorage<T>* duplicate() const = 0;
 	virtual void clear() = 0;
+
+	/** Bytes allocated by the storage (not counting the object itself) */
+	virtual size_t memoryUsage() const = 0;
+
+	/** Keeps at most maxPoints points from now on (ignored by storages of fixed size) */
+	virtual void setCapacity(size_t maxPoints) { }
 };
@@ -0,0 +1,197 @@
+/*
+ * IntensityGrid.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+
+/**
+ * Fixed size columns x rows histogram of hit counts, in the spirit of the
+ * phosphor of an analog oscilloscope. Hits are cheap integer increments,
+ * and old hits fade away through decayColumn().
+ *
+ * Row 0 is the bottom row (lowest value).
+ */
+class IntensityGrid {
+public:
+	IntensityGrid(int columns, int rows) :
+		_columns(columns),
+		_rows(rows),
+		_counts(columns * rows, 0)
+	{
+		assert(columns > 0);
+		assert(rows > 0 && (rows & 1) == 0); // Needs to be even to be foldable
+	}
+
+	int getColumns() const { return _columns; }
+
+	int getRows() const { return _rows; }
+
+	/** Bytes allocated for the counts */
+	size_t memoryUsage() const { return _counts.capacity() * sizeof(_counts[0]); }
+
+	void hit(int column, int row)
+	{
+		_counts[row * _columns + column]++;
+	}
+
+	uint32_t get(int column, int row) const
+	{
+		return _counts[row * _columns + column];
+	}
+
+	/**
+	 * Removes (rounded up) 1/2^shift of the hits in one column,
+	 * so even single hits eventually disappear.
+	 */
+	void decayColumn(int column, int shift)
+	{
+		const uint32_t roundUp = (1u << shift) - 1;
+		for (int row = 0; row < _rows; row++)
+		{
+			uint32_t& count = _counts[row * _columns + column];
+			count -= (count + roundUp) >> shift;
+		}
+	}
+
+	/** As decayColumn(), for a row */
+	void decayRow(int row, int shift)
+	{
+		const uint32_t roundUp = (1u << shift) - 1;
+		uint32_t* counts = &_counts[row * _columns];
+		for (int column = 0; column < _columns; column++)
+		{
+			counts[column] -= (counts[column] + roundUp) >> shift;
+		}
+	}
+
+	/**
+	 * Halves the vertical resolution by merging pairs of rows.
+	 * @param toUpperHalf If true, the merged rows end up in the upper half
+	 *                    of the grid (use when growing the range downwards),
+	 *                    otherwise in the lower half (growing upwards).
+	 */
+	void foldRows(bool toUpperHalf)
+	{
+		const int half = _rows / 2;
+		std::vector<uint32_t> folded(_counts.size(), 0);
+		for (int i = 0; i < half; i++)
+		{
+			int dstRow = toUpperHalf ? half + i : i;
+			for (int column = 0; column < _columns; column++)
+			{
+				folded[dstRow * _columns + column] =
+						_counts[(2*i) * _columns + column] +
+						_counts[(2*i + 1) * _columns + column];
+			}
+		}
+		_counts.swap(folded);
+	}
+
+	/**
+	 * Halves the horizontal resolution by merging pairs of columns (of
+	 * which there needs to be an even number).
+	 * @param toRightHalf If true, the merged columns end up in the right
+	 *                    half of the grid (use when growing the range to
+	 *                    the left), otherwise in the left half.
+	 */
+	void foldColumns(bool toRightHalf)
+	{
+		assert((_columns & 1) == 0);
+		const int half = _columns / 2;
+		for (int row = 0; row < _rows; row++)
+		{
+			uint32_t* counts = &_counts[row * _columns];
+			if (toRightHalf)
+			{
+				for (int i = half - 1; i >= 0; i--)
+				{
+					counts[half + i] = counts[2*i] + counts[2*i + 1];
+				}
+				std::fill(counts, counts + half, 0);
+			}
+			else
+			{
+				for (int i = 0; i < half; i++)
+				{
+					counts[i] = counts[2*i] + counts[2*i + 1];
+				}
+				std::fill(counts + half, counts + _columns, 0);
+			}
+		}
+	}
+
+	uint32_t getMaxCount() const
+	{
+		uint32_t maxCount = 0;
+		for (const auto& count : _counts)
+		{
+			if (count > maxCount) { maxCount = count; }
+		}
+		return maxCount;
+	}
+
+	void clear()
+	{
+		_counts.assign(_counts.size(), 0);
+	}
+
+	/**
+	 * Maps a hit count to a 0x00RRGGBB colour on a dark blue - green -
+	 * yellow - red - white ramp. Logarithmic, so single hits stay visible
+	 * next to very frequently hit pixels. Returns 0 (black) for no hits.
+	 */
+	static uint32_t countToRGB(uint32_t count, uint32_t maxCount)
+	{
+		if (count == 0)
+		{
+			return 0;
+		}
+
+		double level = 0;
+		if (maxCount > 1)
+		{
+			level = log(double(count)) / log(double(maxCount));
+		}
+
+		// Control points of the colour ramp
+		static const double ramp[][3] = {
+				{  32,  32, 160 },
+				{   0, 200, 255 },
+				{   0, 255,  64 },
+				{ 255, 255,   0 },
+				{ 255,  32,   0 },
+				{ 255, 255, 255 },
+		};
+		const int numSegments = sizeof(ramp)/sizeof(ramp[0]) - 1;
+
+		double pos = level * numSegments;
+		int segment = int(pos);
+		if (segment >= numSegments) { segment = numSegments - 1; }
+		double frac = pos - segment;
+
+		uint32_t rgb = 0;
+		for (int c = 0; c < 3; c++)
+		{
+			double v = ramp[segment][c] + frac * (ramp[segment + 1][c] - ramp[segment][c]);
+			rgb = (rgb << 8) | (uint32_t(v) & 0xff);
+		}
+		return rgb ? rgb : 1;
+	}
+
+private:
+	int _columns;
+	int _rows;
+	std::vector<uint32_t> _counts;
+};
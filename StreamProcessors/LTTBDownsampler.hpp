@@ -0,0 +1,200 @@
+/*
+ * LTTBDownsampler.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+#include "MinMax.hpp"
+
+#include <vector>
+
+#include <math.h>
+#include <stddef.h>
+
+/**
+ * Reduces a waveform to a polyline of (at most) a given number of points
+ * that keeps the visual shape, using Largest-Triangle-Three-Buckets.
+ *
+ * The min/max pairs of the waveform are first flattened into a zig-zag
+ * line through every min and max. When that line is much longer than the
+ * wanted number of points, each of 2 * numPoints buckets is first reduced
+ * to its min and max point (MinMaxLTTB), so the LTTB pass stays cheap and
+ * no peaks are lost to the preselection.
+ *
+ * x of the returned points is the index into the waveform (where the
+ * second point of a min/max pair is placed half way to the next index).
+ */
+template<class T>
+class LTTBDownsampler {
+public:
+	struct Point {
+		double x;
+		double y;
+		Point(double x, double y) : x(x), y(y) { }
+	};
+
+	/** Buffers are kept between calls to avoid reallocating every frame */
+	const std::vector<Point>& downsample(const std::vector<MinMax<T> >& waveform, size_t numPoints)
+	{
+		flatten(waveform, _flattened);
+
+		if (_flattened.size() > numPoints * _preselectionRatio && numPoints > 2)
+		{
+			preselectMinMax(_flattened, numPoints * _preselectionRatio / 2, _preselected);
+			lttb(_preselected, numPoints, _result);
+		}
+		else
+		{
+			lttb(_flattened, numPoints, _result);
+		}
+		return _result;
+	}
+
+	/**
+	 * Zig-zag through min and max of each pair, visiting first the one
+	 * closest to the previous point to keep the line continuous.
+	 */
+	static void flatten(const std::vector<MinMax<T> >& waveform, std::vector<Point>& out)
+	{
+		out.clear();
+		for (size_t i = 0; i < waveform.size(); i++)
+		{
+			const MinMax<T>& val = waveform[i];
+			if (val.min == val.max)
+			{
+				out.push_back(Point(i, val.min));
+				continue;
+			}
+
+			bool minFirst = out.empty() ||
+					fabs(out.back().y - val.min) <= fabs(out.back().y - val.max);
+			out.push_back(Point(i, minFirst ? val.min : val.max));
+			out.push_back(Point(i + 0.5, minFirst ? val.max : val.min));
+		}
+	}
+
+	/**
+	 * Keeps the first and last point, and the min and max point of each of
+	 * numBuckets equally sized buckets in between (in x order).
+	 */
+	static void preselectMinMax(const std::vector<Point>& in, size_t numBuckets, std::vector<Point>& out)
+	{
+		out.clear();
+		if (in.size() <= 2 || numBuckets == 0)
+		{
+			out = in;
+			return;
+		}
+
+		out.push_back(in.front());
+		const size_t inner = in.size() - 2;
+		for (size_t bucket = 0; bucket < numBuckets; bucket++)
+		{
+			size_t start = 1 + bucket * inner / numBuckets;
+			size_t end = 1 + (bucket + 1) * inner / numBuckets;
+			if (start == end)
+			{
+				continue;
+			}
+
+			size_t minIndex = start;
+			size_t maxIndex = start;
+			for (size_t i = start + 1; i < end; i++)
+			{
+				if (in[i].y < in[minIndex].y) { minIndex = i; }
+				if (in[i].y > in[maxIndex].y) { maxIndex = i; }
+			}
+
+			if (minIndex == maxIndex)
+			{
+				out.push_back(in[minIndex]);
+			}
+			else if (minIndex < maxIndex)
+			{
+				out.push_back(in[minIndex]);
+				out.push_back(in[maxIndex]);
+			}
+			else
+			{
+				out.push_back(in[maxIndex]);
+				out.push_back(in[minIndex]);
+			}
+		}
+		out.push_back(in.back());
+	}
+
+	/**
+	 * Largest-Triangle-Three-Buckets (Steinarsson, 2013). Keeps the first
+	 * and last point, and from each bucket in between the point spanning
+	 * the largest triangle with the previously selected point and the
+	 * average of the next bucket.
+	 */
+	static void lttb(const std::vector<Point>& in, size_t numPoints, std::vector<Point>& out)
+	{
+		out.clear();
+		if (numPoints >= in.size() || numPoints < 3)
+		{
+			out = in;
+			return;
+		}
+
+		const double bucketSize = double(in.size() - 2) / (numPoints - 2);
+
+		size_t selected = 0;
+		out.push_back(in[0]);
+
+		for (size_t bucket = 0; bucket < numPoints - 2; bucket++)
+		{
+			// Average of the next bucket (or the last point)
+			size_t nextStart = size_t(floor((bucket + 1) * bucketSize)) + 1;
+			size_t nextEnd = size_t(floor((bucket + 2) * bucketSize)) + 1;
+			if (nextEnd > in.size()) { nextEnd = in.size(); }
+			if (nextStart >= nextEnd) { nextStart = nextEnd - 1; }
+
+			double avgX = 0;
+			double avgY = 0;
+			for (size_t i = nextStart; i < nextEnd; i++)
+			{
+				avgX += in[i].x;
+				avgY += in[i].y;
+			}
+			avgX /= (nextEnd - nextStart);
+			avgY /= (nextEnd - nextStart);
+
+			size_t start = size_t(floor(bucket * bucketSize)) + 1;
+			size_t end = size_t(floor((bucket + 1) * bucketSize)) + 1;
+
+			const Point& a = in[selected];
+			double maxArea = -1;
+			size_t maxIndex = start;
+			for (size_t i = start; i < end; i++)
+			{
+				// Twice the triangle area, which is fine for comparisons
+				double area = fabs(
+						(a.x - avgX) * (in[i].y - a.y) -
+						(a.x - in[i].x) * (avgY - a.y));
+				if (area > maxArea)
+				{
+					maxArea = area;
+					maxIndex = i;
+				}
+			}
+
+			out.push_back(in[maxIndex]);
+			selected = maxIndex;
+		}
+
+		out.push_back(in.back());
+	}
+
+private:
+	enum { _preselectionRatio = 4 };
+	std::vector<Point> _flattened;
+	std::vector<Point> _preselected;
+	std::vector<Point> _result;
+};
@@ -0,0 +1,124 @@
+/*
+ * LatencyHistogram.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <stdint.h>
+
+/**
+ * Histogram of non negative values (such as latencies in nanoseconds) with
+ * a fixed relative precision, in the style of HdrHistogram.
+ *
+ * Values below 128 get a bucket each. Above that, every power of two range
+ * is split into 64 linear buckets, so a percentile is never off by more
+ * than 1/64 (1.6%) of its value, whatever the magnitude. Recording is a
+ * count leading zeros and an increment. Minimum and maximum are exact.
+ */
+class LatencyHistogram {
+public:
+	LatencyHistogram() :
+		_buckets(bucketIndex(std::numeric_limits<uint64_t>::max()) + 1, 0)
+	{
+		clear();
+	}
+
+	void record(uint64_t value)
+	{
+		_buckets[bucketIndex(value)]++;
+		_count++;
+		_sum += value;
+		if (value < _min) { _min = value; }
+		if (value > _max) { _max = value; }
+	}
+
+	void clear()
+	{
+		std::fill(_buckets.begin(), _buckets.end(), 0);
+		_count = 0;
+		_sum = 0;
+		_min = std::numeric_limits<uint64_t>::max();
+		_max = 0;
+	}
+
+	uint64_t getCount() const { return _count; }
+
+	/** Only valid when getCount() > 0 */
+	uint64_t getMin() const { return _min; }
+
+	uint64_t getMax() const { return _max; }
+
+	double getMean() const { return _count ? double(_sum) / _count : 0; }
+
+	/**
+	 * Smallest value that at least percentile % of the recorded values are
+	 * less than or equal to (within the precision of the buckets, rounding up).
+	 */
+	uint64_t getPercentile(double percentile) const
+	{
+		if (_count == 0)
+		{
+			return 0;
+		}
+
+		uint64_t rank = uint64_t(percentile / 100.0 * _count + 0.5);
+		if (rank < 1) { rank = 1; }
+		if (rank > _count) { rank = _count; }
+
+		uint64_t seen = 0;
+		for (size_t i = 0; i < _buckets.size(); i++)
+		{
+			seen += _buckets[i];
+			if (seen >= rank)
+			{
+				uint64_t value = bucketUpperBound(i);
+				return value < _max ? value : _max;
+			}
+		}
+		return _max;
+	}
+
+	static size_t bucketIndex(uint64_t value)
+	{
+		if (value < LINEAR_BUCKETS)
+		{
+			return value;
+		}
+		int shift = (63 - __builtin_clzll(value)) - (SUB_BITS - 1);
+		return LINEAR_BUCKETS + (shift - 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS);
+	}
+
+	/** Largest value ending up in bucket index */
+	static uint64_t bucketUpperBound(size_t index)
+	{
+		if (index < LINEAR_BUCKETS)
+		{
+			return index;
+		}
+		int shift = (index - LINEAR_BUCKETS) / SUB_BUCKETS + 1;
+		uint64_t mantissa = (index - LINEAR_BUCKETS) % SUB_BUCKETS + SUB_BUCKETS;
+		return ((mantissa + 1) << shift) - 1;
+	}
+
+private:
+	enum {
+		SUB_BITS = 7,
+		SUB_BUCKETS = 1 << (SUB_BITS - 1),  // per power of two
+		LINEAR_BUCKETS = 1 << SUB_BITS,
+	};
+
+	std::vector<uint64_t> _buckets;
+	uint64_t _count;
+	uint64_t _sum;
+	uint64_t _min;
+	uint64_t _max;
+};
@@ -26,7 +26,7 @@ struct MinMax {
 	void reset()
 	{
 		min = std::numeric_limits<T>::max();
-		max = std::numeric_limits<T>::min();
+		max = std::numeric_limits<T>::lowest();
 	}
 	T min;
 	T max;
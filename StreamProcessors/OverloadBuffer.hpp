@@ -0,0 +1,134 @@
+/*
+ * OverloadBuffer.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <assert.h>
+#include <stddef.h>
+
+/**
+ * Bounded holding area for samples of one channel that arrive while the
+ * storage is busy (locked by the renderer), so the reader never has to wait.
+ *
+ * When full, the policy decides what is lost:
+ *  - DROP_OLDEST discards the oldest held sample
+ *  - DROP_NEWEST discards the arriving sample
+ *  - DECIMATE reduces every 4 held samples to their min and max (in the
+ *    order they arrived), halving the contents but keeping the envelope
+ */
+template<class T>
+class OverloadBuffer {
+public:
+	enum Policy { DROP_OLDEST, DROP_NEWEST, DECIMATE };
+
+	/**
+	 * @param capacity maximum number of held samples (a multiple of 4)
+	 */
+	OverloadBuffer(Policy policy, size_t capacity = 4096) :
+		_policy(policy),
+		_data(capacity),
+		_begin(0),
+		_size(0)
+	{
+		assert(capacity >= 4 && capacity % 4 == 0);
+	}
+
+	Policy getPolicy() const { return _policy; }
+
+	bool empty() const { return _size == 0; }
+
+	size_t size() const { return _size; }
+
+	/**
+	 * Holds on to val until the next flush()
+	 * @return number of samples lost because the buffer was full
+	 */
+	size_t push(T val)
+	{
+		size_t lost = 0;
+		if (_size == _data.size())
+		{
+			switch (_policy)
+			{
+			case DROP_NEWEST:
+				return 1;
+
+			case DROP_OLDEST:
+				_begin = wrap(_begin + 1);
+				_size--;
+				lost = 1;
+				break;
+
+			case DECIMATE:
+				lost = reduceToMinMax();
+				break;
+			}
+		}
+
+		_data[wrap(_begin + _size)] = val;
+		_size++;
+		return lost;
+	}
+
+	/**
+	 * Calls fn(val) for each held sample, oldest first, and empties the buffer
+	 */
+	template<class Fn>
+	void flush(Fn& fn)
+	{
+		for (size_t i = 0; i < _size; i++)
+		{
+			fn(_data[wrap(_begin + i)]);
+		}
+		_begin = 0;
+		_size = 0;
+	}
+
+private:
+	Policy _policy;
+	std::vector<T> _data;
+	size_t _begin;
+	size_t _size;
+	std::vector<T> _scratch;
+
+	size_t wrap(size_t i) const
+	{
+		return i < _data.size() ? i : i - _data.size();
+	}
+
+	/** @return number of samples removed */
+	size_t reduceToMinMax()
+	{
+		std::vector<T>& reduced = _scratch;
+		reduced.clear();
+		for (size_t i = 0; i + 4 <= _size; i += 4)
+		{
+			size_t minIndex = i;
+			size_t maxIndex = i;
+			for (size_t j = i + 1; j < i + 4; j++)
+			{
+				if (_data[wrap(_begin + j)] < _data[wrap(_begin + minIndex)]) { minIndex = j; }
+				if (_data[wrap(_begin + j)] > _data[wrap(_begin + maxIndex)]) { maxIndex = j; }
+			}
+			const T& min = _data[wrap(_begin + minIndex)];
+			const T& max = _data[wrap(_begin + maxIndex)];
+			reduced.push_back(minIndex < maxIndex ? min : max);
+			reduced.push_back(minIndex < maxIndex ? max : min);
+		}
+
+		size_t removed = _size - reduced.size();
+		std::copy(reduced.begin(), reduced.end(), _data.begin());
+		_begin = 0;
+		_size = reduced.size();
+		return removed;
+	}
+};
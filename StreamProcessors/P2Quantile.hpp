@@ -0,0 +1,159 @@
+/*
+ * P2Quantile.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+#include <algorithm>
+
+#include <math.h>
+#include <stdint.h>
+
+/**
+ * Estimates a quantile (such as the median, for p = 0.5) of all samples
+ * pushed, in constant time and space, by the P-square algorithm of Jain and
+ * Chlamtac.
+ *
+ * Five markers are kept: the min, the max, the estimated p quantile and
+ * two halfway between. Each sample moves the positions of the markers
+ * above it, and markers off from where they ought to be get their heights
+ * adjusted by a parabolic (or, when that is out of order, linear)
+ * interpolation of their neighbours. Exact for the first five samples.
+ */
+class P2Quantile {
+public:
+	explicit P2Quantile(double p) :
+		_p(p)
+	{
+		reset();
+	}
+
+	void push(double value)
+	{
+		if (_count < 5)
+		{
+			_heights[_count++] = value;
+			if (_count == 5)
+			{
+				std::sort(_heights, _heights + 5);
+			}
+			return;
+		}
+		_count++;
+
+		// The cell the sample falls into, extending the ends if needed
+		int k;
+		if (value < _heights[0])
+		{
+			_heights[0] = value;
+			k = 0;
+		}
+		else if (value >= _heights[4])
+		{
+			_heights[4] = value;
+			k = 3;
+		}
+		else
+		{
+			k = 0;
+			while (value >= _heights[k + 1])
+			{
+				k++;
+			}
+		}
+
+		for (int i = k + 1; i < 5; i++)
+		{
+			_positions[i]++;
+		}
+		for (int i = 0; i < 5; i++)
+		{
+			_desired[i] += _increments[i];
+		}
+
+		for (int i = 1; i < 4; i++)
+		{
+			const double d = _desired[i] - _positions[i];
+			if ((d >= 1 && _positions[i + 1] - _positions[i] > 1) ||
+				(d <= -1 && _positions[i - 1] - _positions[i] < -1))
+			{
+				const int step = d > 0 ? 1 : -1;
+				double height = parabolic(i, step);
+				if (!(_heights[i - 1] < height && height < _heights[i + 1]))
+				{
+					height = linear(i, step);
+				}
+				_heights[i] = height;
+				_positions[i] += step;
+			}
+		}
+	}
+
+	void reset()
+	{
+		_count = 0;
+		for (int i = 0; i < 5; i++)
+		{
+			_heights[i] = 0;
+			_positions[i] = i + 1;
+		}
+		_desired[0] = 1;
+		_desired[1] = 1 + 2 * _p;
+		_desired[2] = 1 + 4 * _p;
+		_desired[3] = 3 + 2 * _p;
+		_desired[4] = 5;
+		_increments[0] = 0;
+		_increments[1] = _p / 2;
+		_increments[2] = _p;
+		_increments[3] = (1 + _p) / 2;
+		_increments[4] = 1;
+	}
+
+	uint64_t getCount() const { return _count; }
+
+	/**
+	 * The estimated quantile (the nearest rank while there are up to five samples)
+	 * @warning returns 0 when no samples were pushed
+	 */
+	double getQuantile() const
+	{
+		if (_count >= 5)
+		{
+			return _heights[2];
+		}
+		if (_count == 0)
+		{
+			return 0;
+		}
+		double sorted[5];
+		std::copy(_heights, _heights + _count, sorted);
+		std::sort(sorted, sorted + _count);
+		return sorted[int(lround(_p * (_count - 1)))];
+	}
+
+private:
+	double _p;
+	uint64_t _count;
+	double _heights[5];
+	int64_t _positions[5];   // 1 based ranks of the markers
+	double _desired[5];      // where the markers ought to be
+	double _increments[5];   // of the desired positions per sample
+
+	double parabolic(int i, int d) const
+	{
+		const double n0 = _positions[i - 1], n1 = _positions[i], n2 = _positions[i + 1];
+		return _heights[i] + d / (n2 - n0) *
+				((n1 - n0 + d) * (_heights[i + 1] - _heights[i]) / (n2 - n1) +
+				 (n2 - n1 - d) * (_heights[i] - _heights[i - 1]) / (n1 - n0));
+	}
+
+	double linear(int i, int d) const
+	{
+		return _heights[i] + d * (_heights[i + d] - _heights[i]) / double(_positions[i + d] - _positions[i]);
+	}
+};
@@ -0,0 +1,205 @@
+/*
+ * PersistenceStorageWaveform.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+
+#include "IWaveformStorage.hpp"
+#include "IntensityGrid.hpp"
+#include "MinMax.hpp"
+
+#include <vector>
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+
+
+/**
+ * Digital phosphor style storage. Samples sweep from left to right over
+ * the columns of an IntensityGrid (sweepLength samples per sweep), and
+ * every sample adds one hit to the cell it falls into. A column loses part
+ * of its hits each time the sweep enters it again.
+ *
+ * Unless a fixed value range is given, the range grows automatically
+ * (doubling, while merging pairs of rows) when samples fall outside it.
+ * Samples that are inf or NaN are left out (but kept as the last sample).
+ *
+ * getWaveform() returns min/max per column, with the columns already
+ * passed in the current sweep being overwritten.
+ */
+template<class T>
+class PersistenceStorageWaveform final : public IWaveformStorage<T> {
+public:
+
+	PersistenceStorageWaveform(int sweepLength = 4096, int columns = 740, int rows = 480, int decayShift = 3) :
+	_sweepLength(sweepLength),
+	_decayShift(decayShift),
+	_fixedRange(false),
+	_grid(columns, rows),
+	_lastSample()
+	{
+		clear();
+	}
+
+	/**
+	 * Only count samples in [min, max). Disables automatic range growth.
+	 */
+	void setRange(double min, double max)
+	{
+		_fixedRange = true;
+		_hasRange = true;
+		_rangeMin = min;
+		setBinHeight((max - min) / _grid.getRows());
+		_grid.clear();
+	}
+
+	void push(T val)
+	{
+		_lastSample = val;
+		if (!isfinite(double(val)))
+		{
+			return; // No place in the grid (and would grow the range forever)
+		}
+
+		if (_waveform.size() <= size_t(_column))
+		{
+			_waveform.push_back(MinMax<T>(val, val));
+		}
+		else if (_isNewColumn)
+		{
+			_waveform[_column] = MinMax<T>(val, val);
+		}
+		else
+		{
+			_waveform[_column].update(val);
+		}
+		_isNewColumn = false;
+
+		double pos = (val - _rangeMin) * _binsPerUnit;
+		bool fits = _hasRange && pos >= 0 && pos < _grid.getRows();
+		if (!fits && !_fixedRange)
+		{
+			growRangeToFit(val);
+			pos = (val - _rangeMin) * _binsPerUnit;
+		}
+		if (pos >= 0 && pos < _grid.getRows())
+		{
+			_grid.hit(_column, int(pos));
+		}
+
+		advance();
+	}
+
+	const std::vector<MinMax<T> >& getWaveform() const {
+		return _waveform;
+	}
+
+	const T getLastSample() const {
+		return _lastSample;
+	}
+
+	const IntensityGrid& getGrid() const {
+		return _grid;
+	}
+
+	/** Value at the bottom edge of the grid */
+	double getRangeMin() const { return _rangeMin; }
+
+	/** Value at the top edge of the grid */
+	double getRangeMax() const { return _rangeMin + _grid.getRows() * _binHeight; }
+
+	IWaveformStorage<T>* duplicate() const
+	{
+		return new PersistenceStorageWaveform(*this);
+	}
+
+	size_t memoryUsage() const
+	{
+		return _grid.memoryUsage() + _waveform.capacity() * sizeof(_waveform[0]);
+	}
+
+	void clear()
+	{
+		_grid.clear();
+		_waveform.clear();
+		_sampleInSweep = 0;
+		_column = 0;
+		_isNewColumn = true;
+		if (!_fixedRange)
+		{
+			_hasRange = false;
+			_rangeMin = 0;
+			setBinHeight(1.0 / _grid.getRows());
+		}
+	}
+
+private:
+	int _sweepLength;
+	int _decayShift;
+	bool _fixedRange;
+	bool _hasRange;
+	double _rangeMin;
+	double _binHeight;
+	double _binsPerUnit;
+	int _sampleInSweep;
+	int _column;
+	bool _isNewColumn;
+	IntensityGrid _grid;
+	std::vector<MinMax<T> > _waveform;
+	T _lastSample;
+
+	void setBinHeight(double binHeight)
+	{
+		_binHeight = binHeight;
+		_binsPerUnit = 1.0 / binHeight;
+	}
+
+	void advance()
+	{
+		_sampleInSweep++;
+		if (_sampleInSweep == _sweepLength)
+		{
+			_sampleInSweep = 0;
+		}
+
+		int column = int(int64_t(_sampleInSweep) * _grid.getColumns() / _sweepLength);
+		if (column != _column)
+		{
+			_column = column;
+			_isNewColumn = true;
+			_grid.decayColumn(_column, _decayShift);
+		}
+	}
+
+	void growRangeToFit(double val)
+	{
+		if (!_hasRange)
+		{
+			// Start out with a tiny range around the first sample
+			double span = (val != 0) ? fabs(val) * 1e-3 : 1e-3;
+			_rangeMin = val - span / 2;
+			setBinHeight(span / _grid.getRows());
+			_hasRange = true;
+			return;
+		}
+
+		while (val < _rangeMin)
+		{
+			_rangeMin -= _grid.getRows() * _binHeight;
+			setBinHeight(_binHeight * 2);
+			_grid.foldRows(true);
+		}
+		while (val >= getRangeMax())
+		{
+			setBinHeight(_binHeight * 2);
+			_grid.foldRows(false);
+		}
+	}
+};
@@ -0,0 +1,71 @@
+/*
+ * RunningStatistics.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+#include <limits>
+
+#include <math.h>
+#include <stdint.h>
+
+/**
+ * Count, mean, standard deviation, min and max of all samples pushed,
+ * updated in constant time and space.
+ *
+ * The mean and variance are updated as by Welford, which (unlike summing
+ * squares) doesn't lose precision when the mean is large compared to the
+ * spread.
+ */
+class RunningStatistics {
+public:
+	RunningStatistics()
+	{
+		reset();
+	}
+
+	void push(double value)
+	{
+		_count++;
+		const double delta = value - _mean;
+		_mean += delta / _count;
+		_m2 += delta * (value - _mean);
+		if (value < _min) { _min = value; }
+		if (value > _max) { _max = value; }
+	}
+
+	void reset()
+	{
+		_count = 0;
+		_mean = 0;
+		_m2 = 0;
+		_min = std::numeric_limits<double>::max();
+		_max = std::numeric_limits<double>::lowest();
+	}
+
+	uint64_t getCount() const { return _count; }
+
+	/** @warning returns 0 when no samples were pushed */
+	double getMean() const { return _mean; }
+
+	/** Sample variance (dividing by count - 1). 0 for less than two samples */
+	double getVariance() const { return _count > 1 ? _m2 / (_count - 1) : 0; }
+
+	double getStdDev() const { return sqrt(getVariance()); }
+
+	/** @warning only meaningful when samples were pushed */
+	double getMin() const { return _min; }
+	double getMax() const { return _max; }
+
+private:
+	uint64_t _count;
+	double _mean;
+	double _m2; // Sum of squared differences from the mean
+	double _min;
+	double _max;
+};
@@ -0,0 +1,129 @@
+/*
+ * SpectrumAnalyzer.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+#include "FFT.hpp"
+
+#include <algorithm>
+#include <complex>
+#include <string>
+#include <vector>
+
+#include <math.h>
+
+/**
+ * Magnitude spectra of windows of samples, averaged over time.
+ *
+ * Each window of getSize() samples is multiplied by a window function,
+ * transformed, and its power per bin blended into a running average
+ * (exponentially, over about numAverages windows). Magnitudes are in dB
+ * relative to a sine of amplitude 1 centred on a bin, which the window
+ * scaling makes come out as 0 dB.
+ */
+class SpectrumAnalyzer {
+public:
+	enum Window { RECTANGULAR, HANN, HAMMING, BLACKMAN };
+
+	/** @param size of the windows, a power of two */
+	SpectrumAnalyzer(size_t size, Window window = HANN, unsigned numAverages = 1) :
+		_fft(size),
+		_coefficients(size),
+		_numAverages(std::max(1u, numAverages)),
+		_numWindows(0),
+		_buffer(size),
+		_power(size / 2 + 1, 0.0)
+	{
+		double sum = 0;
+		for (size_t i = 0; i < size; i++)
+		{
+			const double x = 2 * M_PI * i / size;
+			switch (window)
+			{
+			case RECTANGULAR: _coefficients[i] = 1; break;
+			case HANN:        _coefficients[i] = 0.5 - 0.5 * cos(x); break;
+			case HAMMING:     _coefficients[i] = 0.54 - 0.46 * cos(x); break;
+			case BLACKMAN:    _coefficients[i] = 0.42 - 0.5 * cos(x) + 0.08 * cos(2 * x); break;
+			}
+			sum += _coefficients[i];
+		}
+		// A sine of amplitude 1 gives a peak of sum / 2
+		for (auto& coefficient : _coefficients)
+		{
+			coefficient *= 2 / sum;
+		}
+	}
+
+	/**
+	 * Parses "rect", "hann", "hamming" or "blackman"
+	 * @return false if it is none of those
+	 */
+	static bool parseWindow(const std::string& name, Window& window)
+	{
+		const char* names[] = { "rect", "hann", "hamming", "blackman" };
+		for (int i = 0; i < 4; i++)
+		{
+			if (name == names[i])
+			{
+				window = Window(i);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	size_t getSize() const { return _fft.getSize(); }
+
+	/** Number of bins (frequencies 0 to half the sample rate) */
+	size_t getNumBins() const { return _power.size(); }
+
+	/** Adds the spectrum of getSize() samples to the average */
+	void add(const double* samples)
+	{
+		for (size_t i = 0; i < _buffer.size(); i++)
+		{
+			_buffer[i] = std::complex<double>(samples[i] * _coefficients[i], 0);
+		}
+		_fft.transform(&_buffer[0]);
+
+		// Until there are numAverages windows, they are weighted equally
+		_numWindows = std::min(_numWindows + 1, _numAverages);
+		const double weight = 1.0 / _numWindows;
+		for (size_t bin = 0; bin < _power.size(); bin++)
+		{
+			_power[bin] += (std::norm(_buffer[bin]) - _power[bin]) * weight;
+		}
+	}
+
+	void reset()
+	{
+		_numWindows = 0;
+		std::fill(_power.begin(), _power.end(), 0.0);
+	}
+
+	/**
+	 * Averaged magnitudes of the bins in dB, no lower than floorDb
+	 */
+	void getMagnitudesDb(std::vector<double>& magnitudes, double floorDb = -200) const
+	{
+		magnitudes.resize(_power.size());
+		for (size_t bin = 0; bin < _power.size(); bin++)
+		{
+			magnitudes[bin] = _power[bin] > 0 ? std::max(floorDb, 10 * log10(_power[bin])) : floorDb;
+		}
+	}
+
+private:
+	FFT _fft;
+	std::vector<double> _coefficients; // of the window, scaled
+	unsigned _numAverages;
+	unsigned _numWindows;
+	std::vector<std::complex<double> > _buffer;
+	std::vector<double> _power; // averaged, per bin
+};
@@ -0,0 +1,68 @@
+/*
+ * StorageDispatch.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+#include "CappedPeakStorageWaveform.hpp"
+#include "CompressedStorageWaveform.hpp"
+#include "FIFOStorageWaveform.hpp"
+#include "IWaveformStorage.hpp"
+#include "PersistenceStorageWaveform.hpp"
+
+/**
+ * Static dispatch to the waveform storages, for the ingest path.
+ *
+ * The kind of storage is fixed at startup. So rather than calling push()
+ * through the vtable for every sample, the caller switches on the kind,
+ * which is always predicted right, and calls the final class directly.
+ * That lets the compiler inline push() into the parse loop.
+ */
+enum class StorageKind { CAPPED_PEAK, FIFO, PERSISTENCE, COMPRESSED };
+
+/**
+ * Calls fn(storage), with storage cast to its own type (which must be kind)
+ */
+template<class T, class Fn>
+inline void visitStorage(StorageKind kind, IWaveformStorage<T>& storage, const Fn& fn)
+{
+	switch (kind)
+	{
+	case StorageKind::CAPPED_PEAK:
+		fn(static_cast<CappedPeakStorageWaveform<T>&>(storage));
+		break;
+	case StorageKind::FIFO:
+		fn(static_cast<FIFOStorageWaveform<T>&>(storage));
+		break;
+	case StorageKind::PERSISTENCE:
+		fn(static_cast<PersistenceStorageWaveform<T>&>(storage));
+		break;
+	case StorageKind::COMPRESSED:
+		fn(static_cast<CompressedStorageWaveform<T>&>(storage));
+		break;
+	}
+}
+
+template<class T>
+struct StoragePush {
+	T value;
+
+	template<class Storage>
+	void operator()(Storage& storage) const
+	{
+		storage.push(value);
+	}
+};
+
+/** Same as storage.push(value), without the virtual call */
+template<class T>
+inline void pushToStorage(StorageKind kind, IWaveformStorage<T>& storage, T value)
+{
+	StoragePush<T> push = { value };
+	visitStorage(kind, storage, push);
+}
@@ -0,0 +1,213 @@
+/*
+ * TriggerCapture.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Oscilloscope style edge trigger over several channels.
+ *
+ * Every channel continuously keeps its last preTriggerSamples samples in a
+ * ring buffer. When the trigger channel crosses the level in the selected
+ * direction, the rings of all channels are frozen into a new capture, which
+ * is then completed with up to postTriggerSamples samples per channel.
+ * Once the trigger channel has its post trigger samples, the capture
+ * replaces the previously completed one and the trigger re-arms.
+ *
+ * Channels are not assumed to be sampled at the same rate, so each channel
+ * gets the samples it has seen around the trigger event.
+ *
+ * The channels only share two atomic counters (of trigger events and of
+ * completed captures). Each channel freezes its own ring when it first
+ * sees a new trigger event (on its next sample, or when its capture is
+ * read). So push() and getCapture() of different channels may run at the
+ * same time, as long as those of one channel don't (as under a lock per
+ * channel).
+ */
+template<class T>
+class TriggerCapture {
+public:
+	enum Edge { RISING, FALLING };
+
+	struct Capture {
+		/** Position of samples[0] within the pre + post trigger window */
+		size_t offset;
+		std::vector<T> samples;
+		Capture() : offset(0) { }
+	};
+
+	TriggerCapture(size_t numChannels, size_t triggerChannel, T level, Edge edge,
+			size_t preTriggerSamples, size_t postTriggerSamples) :
+		_triggerChannel(triggerChannel),
+		_level(level),
+		_edge(edge),
+		_sign(edge == RISING ? 1 : -1),
+		_signedLevel(_sign * level),
+		_previousSigned(_signedLevel),
+		_preTriggerSamples(preTriggerSamples),
+		_postTriggerSamples(postTriggerSamples),
+		_numEvents(0),
+		_numCaptures(0),
+		_channels(numChannels)
+	{
+		assert(triggerChannel < numChannels);
+		assert(postTriggerSamples > 0);
+		for (auto& channel : _channels)
+		{
+			channel.ring.samples.resize(preTriggerSamples);
+		}
+	}
+
+	void push(size_t channel, T val)
+	{
+		uint64_t numEvents = _numEvents.load(std::memory_order_acquire);
+		if (channel == _triggerChannel)
+		{
+			// Branch free edge detection. Falling edges are rising edges of -val.
+			// Armed once the capture of the last event is complete.
+			T signedVal = _sign * val;
+			bool armed = _numCaptures.load(std::memory_order_relaxed) == numEvents;
+			bool fired = (_previousSigned < _signedLevel) & (signedVal >= _signedLevel) & armed;
+			_previousSigned = signedVal;
+			if (fired)
+			{
+				_numEvents.store(++numEvents, std::memory_order_release);
+			}
+		}
+
+		Channel& state = _channels[channel];
+		catchUp(state, numEvents);
+		if (state.pendingEvent)
+		{
+			Capture& capture = state.pending;
+			if (capture.offset + capture.samples.size() < getWindowSize())
+			{
+				capture.samples.push_back(val);
+			}
+			if (channel == _triggerChannel &&
+				capture.offset + capture.samples.size() == getWindowSize())
+			{
+				_numCaptures.store(state.pendingEvent, std::memory_order_release);
+				catchUp(state, numEvents);
+			}
+		}
+
+		Ring& ring = state.ring;
+		if (_preTriggerSamples)
+		{
+			ring.samples[ring.pos] = val;
+			ring.pos++;
+			ring.pos = (ring.pos == _preTriggerSamples) ? 0 : ring.pos;
+			ring.count += (ring.count < _preTriggerSamples);
+		}
+	}
+
+	/** Number of completed captures so far */
+	size_t getNumCaptures() const { return _numCaptures.load(std::memory_order_acquire); }
+
+	/**
+	 * The latest completed capture of channel (empty before there is one).
+	 * Not to be called at the same time as push() of channel.
+	 */
+	const Capture& getCapture(size_t channel)
+	{
+		Channel& state = _channels[channel];
+		catchUp(state, _numEvents.load(std::memory_order_acquire));
+		return state.completed;
+	}
+
+	size_t getTriggerChannel() const { return _triggerChannel; }
+
+	T getLevel() const { return _level; }
+
+	Edge getEdge() const { return _edge; }
+
+	size_t getPreTriggerSamples() const { return _preTriggerSamples; }
+
+	/** Length of the complete window around the trigger event */
+	size_t getWindowSize() const { return _preTriggerSamples + _postTriggerSamples; }
+
+private:
+	struct Ring {
+		std::vector<T> samples;
+		size_t pos;
+		size_t count;
+		Ring() : pos(0), count(0) { }
+	};
+
+	/** All of it belongs to one channel (and is guarded with it) */
+	struct Channel {
+		Ring ring;
+		Capture pending;
+		Capture completed;
+		uint64_t pendingEvent; // Trigger event of pending (0 = none)
+		uint64_t frozenEvent;  // Last trigger event the ring was frozen for
+		Channel() : pendingEvent(0), frozenEvent(0) { }
+	};
+
+	const size_t _triggerChannel;
+	const T _level;
+	const Edge _edge;
+	const T _sign;
+	const T _signedLevel;
+	T _previousSigned; // Of the trigger channel
+	const size_t _preTriggerSamples;
+	const size_t _postTriggerSamples;
+	std::atomic<uint64_t> _numEvents;
+	std::atomic<uint64_t> _numCaptures; // Completed, so armed when equal to _numEvents
+	std::vector<Channel> _channels;
+
+	/**
+	 * Completes the pending capture of state once the trigger channel has
+	 * completed it, and freezes the ring for a trigger event not seen before
+	 */
+	void catchUp(Channel& state, uint64_t numEvents)
+	{
+		completeIfDone(state);
+		if (state.frozenEvent != numEvents)
+		{
+			freeze(state);
+			state.pendingEvent = state.frozenEvent = numEvents;
+			completeIfDone(state); // Without samples after the event
+		}
+	}
+
+	void completeIfDone(Channel& state)
+	{
+		if (state.pendingEvent && state.pendingEvent <= _numCaptures.load(std::memory_order_acquire))
+		{
+			std::swap(state.completed, state.pending);
+			state.pendingEvent = 0;
+		}
+	}
+
+	void freeze(Channel& state)
+	{
+		const Ring& ring = state.ring;
+		Capture& capture = state.pending;
+		capture.samples.clear();
+		capture.offset = _preTriggerSamples - ring.count;
+
+		// Oldest sample first
+		size_t start = (ring.pos + _preTriggerSamples - ring.count) % (_preTriggerSamples ? _preTriggerSamples : 1);
+		for (size_t i = 0; i < ring.count; i++)
+		{
+			size_t index = start + i;
+			if (index >= _preTriggerSamples) { index -= _preTriggerSamples; }
+			capture.samples.push_back(ring.samples[index]);
+		}
+	}
+};
@@ -0,0 +1,200 @@
+/*
+ * XYDensityGrid.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+#include "IntensityGrid.hpp"
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+
+/**
+ * Density of (x, y) points, counted into the cells of an IntensityGrid.
+ * Drawing it costs the same however many points went into it.
+ *
+ * Old points fade away: the rows lose 1/2^decayShift of their hits in turn,
+ * all of them once every decayLength points.
+ *
+ * Unless a fixed range is given, the range of each axis grows automatically
+ * (doubling, while merging pairs of columns or rows) when points fall
+ * outside it. That needs an even number of columns as well as rows.
+ * Points with an inf or NaN coordinate are not counted.
+ */
+class XYDensityGrid {
+public:
+	XYDensityGrid(int columns = 740, int rows = 480, int decayLength = 4096, int decayShift = 3) :
+		_decayLength(decayLength),
+		_decayShift(decayShift),
+		_grid(columns, rows)
+	{
+		assert(decayLength > 0);
+		clear();
+	}
+
+	/**
+	 * Only count points in [minX, maxX) x [minY, maxY). Disables automatic
+	 * range growth.
+	 */
+	void setRange(double minX, double maxX, double minY, double maxY)
+	{
+		_x.setFixed(minX, maxX, _grid.getColumns());
+		_y.setFixed(minY, maxY, _grid.getRows());
+		_grid.clear();
+	}
+
+	void push(double x, double y)
+	{
+		double column = _x.position(x);
+		double row = _y.position(y);
+		if (!(column >= 0 && column < _grid.getColumns() && row >= 0 && row < _grid.getRows()) &&
+			!_x.fixed && isfinite(x) && isfinite(y))
+		{
+			growRangeToFit(x, y);
+			column = _x.position(x);
+			row = _y.position(y);
+		}
+		if (column >= 0 && column < _grid.getColumns() && row >= 0 && row < _grid.getRows())
+		{
+			_grid.hit(int(column), int(row));
+		}
+
+		decay();
+	}
+
+	const IntensityGrid& getGrid() const { return _grid; }
+
+	/** Value at the left edge of the grid */
+	double getRangeMinX() const { return _x.min; }
+
+	/** Value at the right edge of the grid */
+	double getRangeMaxX() const { return _x.max(_grid.getColumns()); }
+
+	/** Value at the bottom edge of the grid */
+	double getRangeMinY() const { return _y.min; }
+
+	/** Value at the top edge of the grid */
+	double getRangeMaxY() const { return _y.max(_grid.getRows()); }
+
+	size_t memoryUsage() const { return _grid.memoryUsage(); }
+
+	void clear()
+	{
+		_grid.clear();
+		_pointInDecay = 0;
+		_row = 0;
+		if (!_x.fixed)
+		{
+			_x.reset(_grid.getColumns());
+			_y.reset(_grid.getRows());
+		}
+	}
+
+private:
+	/** Mapping of the values along one axis to cells */
+	struct Axis {
+		bool fixed;
+		bool hasRange;
+		double min;
+		double cellSize;
+		double cellsPerUnit;
+
+		Axis() : fixed(false) { reset(1); }
+
+		void reset(int numCells)
+		{
+			hasRange = false;
+			min = 0;
+			setCellSize(1.0 / numCells);
+		}
+
+		void setFixed(double min, double max, int numCells)
+		{
+			fixed = true;
+			hasRange = true;
+			this->min = min;
+			setCellSize((max - min) / numCells);
+		}
+
+		void setCellSize(double size)
+		{
+			cellSize = size;
+			cellsPerUnit = 1.0 / size;
+		}
+
+		double max(int numCells) const { return min + numCells * cellSize; }
+
+		/** Cell of value, as a fraction (outside [0, cells) if outside the range) */
+		double position(double value) const
+		{
+			return hasRange ? (value - min) * cellsPerUnit : -1;
+		}
+
+		/**
+		 * Doubles the range (through fold(towardsEnd)) until value fits.
+		 * Starts out with a tiny range around the first value.
+		 */
+		template<class Fold>
+		void growToFit(double value, int numCells, Fold fold)
+		{
+			if (!hasRange)
+			{
+				double span = (value != 0) ? fabs(value) * 1e-3 : 1e-3;
+				min = value - span / 2;
+				setCellSize(span / numCells);
+				hasRange = true;
+				return;
+			}
+
+			while (value < min)
+			{
+				min -= numCells * cellSize;
+				setCellSize(cellSize * 2);
+				fold(true);
+			}
+			while (value >= max(numCells))
+			{
+				setCellSize(cellSize * 2);
+				fold(false);
+			}
+		}
+	};
+
+	int _decayLength;
+	int _decayShift;
+	int _pointInDecay;
+	int _row; // Next row to decay
+	Axis _x;
+	Axis _y;
+	IntensityGrid _grid;
+
+	void growRangeToFit(double x, double y)
+	{
+		IntensityGrid& grid = _grid;
+		_x.growToFit(x, grid.getColumns(), [&](bool toEnd) { grid.foldColumns(toEnd); });
+		_y.growToFit(y, grid.getRows(), [&](bool toEnd) { grid.foldRows(toEnd); });
+	}
+
+	/** Decays the rows due, so every row is decayed once per decayLength points */
+	void decay()
+	{
+		_pointInDecay++;
+		const int rows = _grid.getRows();
+		const int due = int(int64_t(_pointInDecay) * rows / _decayLength);
+		while (_row < due)
+		{
+			_grid.decayRow(_row++, _decayShift);
+		}
+		if (_pointInDecay == _decayLength)
+		{
+			_pointInDecay = 0;
+			_row = 0;
+		}
+	}
+};
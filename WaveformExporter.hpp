@@ -0,0 +1,251 @@
+/*
+ * WaveformExporter.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#pragma once
+
+#include "StreamProcessors/CompressedStorageWaveform.hpp"
+#include "StreamProcessors/MinMax.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Binary exports are, in host byte order:
+ *
+ *   char magic[8] ("RMDPEXP\n"), uint32_t numChannels
+ *   for each channel: uint32_t length, name bytes, uint64_t numPoints,
+ *                     numPoints x (double min, double max)
+ */
+
+/**
+ * Writes snapshots of the waveforms to files on a background thread, so
+ * neither ingest nor rendering waits for the disk.
+ *
+ * Files are named PREFIX<date>-<time>-<number>.csv (or .bin). One export
+ * can wait while another is written. Requests beyond that are refused.
+ */
+class WaveformExporter {
+public:
+	enum Format { CSV, BINARY };
+
+	struct Channel {
+		std::string name;
+		std::vector<MinMax<double> > waveform;
+
+		// When set, every sample of it is written (as min = max) instead of waveform
+		std::shared_ptr<const CompressedStorageWaveform<double> > history;
+	};
+
+	WaveformExporter(const std::string& prefix, Format format) :
+		_prefix(prefix),
+		_format(format),
+		_hasPending(false),
+		_stop(false),
+		_numExports(0)
+	{ }
+
+	/** Finishes writing what was requested */
+	~WaveformExporter()
+	{
+		{
+			std::lock_guard<std::mutex> guard(_mutex);
+			_stop = true;
+		}
+		_wakeup.notify_one();
+		if (_thread.joinable())
+		{
+			_thread.join();
+		}
+	}
+
+	/**
+	 * Queues channels for writing (taking over their contents)
+	 * @return false if an export is already waiting to be written
+	 */
+	bool exportSnapshot(std::vector<Channel>& channels)
+	{
+		{
+			std::lock_guard<std::mutex> guard(_mutex);
+			if (_hasPending)
+			{
+				return false;
+			}
+			_pending.swap(channels);
+			_hasPending = true;
+		}
+		if (!_thread.joinable())
+		{
+			_thread = std::thread(&WaveformExporter::run, this);
+		}
+		_wakeup.notify_one();
+		return true;
+	}
+
+	/** One row per point: index, then min and max of each channel */
+	static bool writeCSV(FILE* f, const std::vector<Channel>& channels)
+	{
+		uint64_t numRows = 0;
+		fprintf(f, "index");
+		for (const auto& channel : channels)
+		{
+			fprintf(f, ",%s min,%s max", channel.name.c_str(), channel.name.c_str());
+			numRows = std::max(numRows, numPoints(channel));
+		}
+		fprintf(f, "\n");
+
+		std::vector<std::vector<MinMax<double> > > chunks(channels.size());
+		for (uint64_t first = 0; first < numRows; first += CHUNK_POINTS)
+		{
+			for (size_t i = 0; i < channels.size(); i++)
+			{
+				getPoints(channels[i], first, chunks[i]);
+			}
+			for (uint64_t row = first; row < std::min<uint64_t>(first + CHUNK_POINTS, numRows); row++)
+			{
+				fprintf(f, "%" PRIu64, row);
+				for (const auto& chunk : chunks)
+				{
+					if (row - first < chunk.size())
+					{
+						fprintf(f, ",%.17g,%.17g", chunk[row - first].min, chunk[row - first].max);
+					}
+					else
+					{
+						fprintf(f, ",,");
+					}
+				}
+				fprintf(f, "\n");
+			}
+		}
+		return !ferror(f);
+	}
+
+	static bool writeBinary(FILE* f, const std::vector<Channel>& channels)
+	{
+		static const char magic[8] = { 'R', 'M', 'D', 'P', 'E', 'X', 'P', '\n' };
+		uint32_t numChannels = channels.size();
+		fwrite(magic, sizeof(magic), 1, f);
+		fwrite(&numChannels, sizeof(numChannels), 1, f);
+		std::vector<MinMax<double> > chunk;
+		for (const auto& channel : channels)
+		{
+			uint32_t length = channel.name.size();
+			uint64_t count = numPoints(channel);
+			fwrite(&length, sizeof(length), 1, f);
+			fwrite(channel.name.data(), length, 1, f);
+			fwrite(&count, sizeof(count), 1, f);
+			for (uint64_t first = 0; first < count; first += CHUNK_POINTS)
+			{
+				getPoints(channel, first, chunk);
+				for (const auto& point : chunk)
+				{
+					double minMax[2] = { point.min, point.max };
+					fwrite(minMax, sizeof(minMax), 1, f);
+				}
+			}
+		}
+		return !ferror(f);
+	}
+
+private:
+	std::string _prefix;
+	Format _format;
+
+	std::thread _thread;
+	std::mutex _mutex;
+	std::condition_variable _wakeup;
+	std::vector<Channel> _pending;
+	bool _hasPending;
+	bool _stop;
+	unsigned _numExports;
+
+	// Points decoded at a time from a history
+	enum { CHUNK_POINTS = 4096 };
+
+	static uint64_t numPoints(const Channel& channel)
+	{
+		return channel.history ? channel.history->getNumSamples() : channel.waveform.size();
+	}
+
+	/** Points [first, first + CHUNK_POINTS) of channel (fewer at its end) */
+	static void getPoints(const Channel& channel, uint64_t first, std::vector<MinMax<double> >& points)
+	{
+		points.clear();
+		if (channel.history)
+		{
+			const auto& add = [&](double value) { points.push_back(MinMax<double>(value, value)); };
+			channel.history->forEachSample(first, CHUNK_POINTS, add);
+		}
+		else if (first < channel.waveform.size())
+		{
+			const size_t end = std::min<uint64_t>(first + CHUNK_POINTS, channel.waveform.size());
+			points.assign(channel.waveform.begin() + first, channel.waveform.begin() + end);
+		}
+	}
+
+	void run()
+	{
+		std::vector<Channel> channels;
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_wakeup.wait(lock, [this]() { return _hasPending || _stop; });
+				if (!_hasPending)
+				{
+					return;
+				}
+				channels.swap(_pending);
+				_pending.clear();
+				_hasPending = false;
+			}
+			write(channels);
+		}
+	}
+
+	void write(const std::vector<Channel>& channels)
+	{
+		char timestamp[32];
+		time_t now = time(0);
+		struct tm local;
+		strftime(timestamp, sizeof(timestamp), "%Y%m%d-%H%M%S", localtime_r(&now, &local));
+
+		char fileName[1024];
+		snprintf(fileName, sizeof(fileName), "%s%s-%u%s", _prefix.c_str(), timestamp,
+				_numExports++, _format == CSV ? ".csv" : ".bin");
+
+		FILE* f = fopen(fileName, "wb");
+		bool ok = f && (_format == CSV ? writeCSV(f, channels) : writeBinary(f, channels));
+		if (f && fclose(f) != 0)
+		{
+			ok = false;
+		}
+
+		if (ok)
+		{
+			fprintf(stderr, "Exported %zu channels to %s\n", channels.size(), fileName);
+		}
+		else
+		{
+			fprintf(stderr, "ERROR: Unable to export to %s: %s\n", fileName, strerror(errno));
+		}
+	}
+};
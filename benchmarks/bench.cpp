@@ -0,0 +1,436 @@
+/*
+ * bench.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+/*
+ * Microbenchmarks of the ingest path.
+ *
+ * Every benchmark is run over a number of samples (several sizes), repeated
+ * until enough time has passed, and the fastest repetition is reported as
+ * ns/sample. bytes/sample is
+ *  - for parsing: bytes of input text per parsed sample
+ *  - for storages: bytes of kept waveform per sample it still represents
+ *  - otherwise: size of the sample type
+ *
+ * Usage: bench [--csv] [path to test_input.txt]
+ */
+
+#include "../LineParser.hpp"
+#include "../StreamProcessors/CappedPeakStorageWaveform.hpp"
+#include "../StreamProcessors/CompressedStorageWaveform.hpp"
+#include "../StreamProcessors/FIFOStorageWaveform.hpp"
+#include "../StreamProcessors/MinMaxCheck.hpp"
+#include "../StreamProcessors/SlidingAverager.hpp"
+#include "../StreamProcessors/StorageDispatch.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+
+static bool csvOutput = false;
+
+// Keeps the compiler from optimizing away benchmarked work
+static volatile double sink;
+
+// Keeps the compiler from knowing the storage kind in advance
+static volatile int opaque = 0;
+
+struct Result {
+	double nsPerSample;
+	double bytesPerSample;
+};
+
+/**
+ * Runs fn() (which processes numSamples samples and returns bytes/sample)
+ * until at least minSeconds have passed, and returns the fastest run.
+ */
+template<class Fn>
+static Result measure(size_t numSamples, Fn fn, double minSeconds = 0.2)
+{
+	Result best = { 1e300, 0 };
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	int runs = 0;
+	do
+	{
+		std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+		double bytesPerSample = fn();
+		std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
+		double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / numSamples;
+		if (ns < best.nsPerSample)
+		{
+			best.nsPerSample = ns;
+			best.bytesPerSample = bytesPerSample;
+		}
+		runs++;
+	} while (runs < 3 ||
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < minSeconds);
+	return best;
+}
+
+static void report(const std::string& name, size_t numSamples, const Result& result)
+{
+	if (csvOutput)
+	{
+		printf("%s,%zu,%.3f,%.3f\n", name.c_str(), numSamples, result.nsPerSample, result.bytesPerSample);
+	}
+	else
+	{
+		printf("%-40s %10zu %12.3f %12.3f\n", name.c_str(), numSamples, result.nsPerSample, result.bytesPerSample);
+	}
+	fflush(stdout);
+}
+
+static std::vector<double> syntheticSamples(size_t numSamples)
+{
+	std::vector<double> samples(numSamples);
+	for (size_t i = 0; i < numSamples; i++)
+	{
+		samples[i] = sin(i * 0.001) + 0.01 * ((i * 7919) % 101);
+	}
+	return samples;
+}
+
+template<class Storage>
+static double storageBytesPerSample(const Storage& storage, size_t representedSamples)
+{
+	return double(storage.getWaveform().size() * sizeof(storage.getWaveform()[0])) / representedSamples;
+}
+
+static void benchStorages(size_t numSamples)
+{
+	const std::vector<double> samples = syntheticSamples(numSamples);
+
+	report("CappedPeakStorageWaveform::push", numSamples, measure(numSamples, [&]() {
+		CappedPeakStorageWaveform<double> storage(4096);
+		for (const auto& sample : samples)
+		{
+			storage.push(sample);
+		}
+		sink = storage.getLastSample();
+		return storageBytesPerSample(storage, samples.size());
+	}));
+
+	report("FIFOStorageWaveform::push", numSamples, measure(numSamples, [&]() {
+		FIFOStorageWaveform<double> storage(4096);
+		for (const auto& sample : samples)
+		{
+			storage.push(sample);
+		}
+		sink = storage.getLastSample();
+		return storageBytesPerSample(storage, std::min<size_t>(samples.size(), 4096));
+	}));
+}
+
+/**
+ * The slowest single push into a storage of many points, which is when it
+ * used to halve its resolution. The storage is filled (and its memory
+ * touched) first, then pushed to past its next halving. Reported as
+ * ns/sample, including the cost of reading the clock.
+ */
+static void benchWorstCasePush(size_t numPoints)
+{
+	const size_t numSamples = 3 * numPoints;
+	const std::vector<double> samples = syntheticSamples(numSamples);
+	CappedPeakStorageWaveform<double> storage(numPoints);
+	for (const auto& sample : samples)
+	{
+		storage.push(sample);
+	}
+
+	double worstNs = 0;
+	for (const auto& sample : samples)
+	{
+		std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+		storage.push(sample);
+		std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+		worstNs = std::max(worstNs, std::chrono::duration<double, std::nano>(t1 - t0).count());
+	}
+	sink = storage.getLastSample();
+
+	Result result = { worstNs, storageBytesPerSample(storage, 2 * numSamples) };
+	report("CappedPeakStorageWaveform worst push", numSamples, result);
+}
+
+static IWaveformStorage<double>* newStorage(StorageKind kind)
+{
+	switch (kind)
+	{
+	case StorageKind::CAPPED_PEAK:
+		return new CappedPeakStorageWaveform<double>(4096);
+	case StorageKind::FIFO:
+		return new FIFOStorageWaveform<double>(4096);
+	case StorageKind::PERSISTENCE:
+		return new PersistenceStorageWaveform<double>(4096);
+	case StorageKind::COMPRESSED:
+		return new CompressedStorageWaveform<double>(4096);
+	}
+	return 0;
+}
+
+/**
+ * push() through the vtable (as main.cpp used to), against pushToStorage()
+ * switching on a kind only known at run time. The storages are kept between
+ * runs, so this is the cost of a push in the steady state.
+ */
+static void benchStorageDispatch(size_t numSamples)
+{
+	const std::vector<double> samples = syntheticSamples(numSamples);
+	const StorageKind kinds[] = { StorageKind::CAPPED_PEAK, StorageKind::FIFO, StorageKind::PERSISTENCE,
+			StorageKind::COMPRESSED };
+	const char* names[] = { "CappedPeak", "FIFO", "Persistence", "Compressed" };
+
+	for (size_t i = 0; i < sizeof(kinds) / sizeof(kinds[0]); i++)
+	{
+		const StorageKind kind = StorageKind(int(kinds[i]) + opaque);
+
+		std::unique_ptr<IWaveformStorage<double> > virtualStorage(newStorage(kind));
+		report(std::string("push virtual ") + names[i], numSamples, measure(numSamples, [&]() {
+			for (const auto& sample : samples)
+			{
+				virtualStorage->push(sample);
+			}
+			sink = virtualStorage->getLastSample();
+			return double(sizeof(double));
+		}));
+
+		std::unique_ptr<IWaveformStorage<double> > staticStorage(newStorage(kind));
+		report(std::string("push static ") + names[i], numSamples, measure(numSamples, [&]() {
+			for (const auto& sample : samples)
+			{
+				pushToStorage(kind, *staticStorage, sample);
+			}
+			sink = staticStorage->getLastSample();
+			return double(sizeof(double));
+		}));
+	}
+}
+
+static void benchStreamProcessors(size_t numSamples)
+{
+	const std::vector<double> samples = syntheticSamples(numSamples);
+	std::vector<int16_t> samples16(numSamples);
+	for (size_t i = 0; i < numSamples; i++)
+	{
+		samples16[i] = int16_t(samples[i] * 10000);
+	}
+
+	report("MinMaxCheck::check", numSamples, measure(numSamples, [&]() {
+		MinMaxCheck check(64, 16);
+		for (const auto& sample : samples16)
+		{
+			check.check(sample);
+		}
+		sink = check.getMax();
+		return double(sizeof(int16_t));
+	}));
+
+	report("SlidingAverager::push+getAverage(16)", numSamples, measure(numSamples, [&]() {
+		SlidingAverager averager(16);
+		double sum = 0;
+		for (const auto& sample : samples)
+		{
+			averager.push(sample);
+			sum += averager.getAverage();
+		}
+		sink = sum;
+		return double(sizeof(double));
+	}));
+}
+
+static void benchParsing(const std::string& name, const std::vector<std::string>& lines,
+		const PrefixMatcher& matcher)
+{
+	size_t numBytes = 0;
+	for (const auto& line : lines)
+	{
+		numBytes += line.size() + 1;
+	}
+
+	// Number of samples found, to get per sample numbers
+	size_t numSamples = 0;
+	{
+		const auto & count = [&](size_t, double) { numSamples++; };
+		for (const auto& line : lines)
+		{
+			matcher.match(line, count);
+		}
+	}
+	if (numSamples == 0)
+	{
+		return;
+	}
+
+	report("PrefixMatcher::match " + name, numSamples, measure(numSamples, [&]() {
+		double sum = 0;
+		const auto & accumulate = [&](size_t, double value) { sum += value; };
+		for (const auto& line : lines)
+		{
+			matcher.match(line, accumulate);
+		}
+		sink = sum;
+		return double(numBytes) / numSamples;
+	}));
+
+	// Only the number part, as found after the prefix
+	std::vector<std::string> numbers;
+	for (const auto& line : lines)
+	{
+		size_t pos = line.find('=');
+		if (pos != line.npos)
+		{
+			numbers.push_back(line.substr(pos + 1));
+		}
+	}
+	size_t numberBytes = 0;
+	for (const auto& number : numbers)
+	{
+		numberBytes += number.size();
+	}
+
+	report("PrefixMatcher::parseNumber " + name, numbers.size(), measure(numbers.size(), [&]() {
+		double sum = 0;
+		for (const auto& number : numbers)
+		{
+			sum += PrefixMatcher::parseNumber(number.c_str());
+		}
+		sink = sum;
+		return double(numberBytes) / numbers.size();
+	}));
+}
+
+/**
+ * Lines as the ingest threads see them: the text read in chunks of
+ * chunkSize bytes (copied, as read(2) would), split by LineSplitter and
+ * matched in place
+ */
+static void benchSplitting(const std::string& name, const std::vector<std::string>& lines,
+		const PrefixMatcher& matcher, size_t chunkSize)
+{
+	std::string text;
+	for (const auto& line : lines)
+	{
+		text += line;
+		text += '\n';
+	}
+	if (text.empty())
+	{
+		return;
+	}
+	std::vector<char> chunk(chunkSize);
+
+	report("LineSplitter::push+match " + name, lines.size(), measure(lines.size(), [&]() {
+		double sum = 0;
+		const auto & accumulate = [&](size_t, double value) { sum += value; };
+		const auto & handleLine = [&](const char* line, size_t size) { matcher.match(line, size, accumulate); };
+		LineSplitter splitter;
+		for (size_t offset = 0; offset < text.size(); offset += chunkSize)
+		{
+			const size_t size = std::min(chunkSize, text.size() - offset);
+			memcpy(&chunk[0], text.data() + offset, size);
+			splitter.push(&chunk[0], size, handleLine);
+		}
+		splitter.finish(handleLine);
+		sink = sum;
+		return double(text.size()) / lines.size();
+	}));
+}
+
+static std::vector<std::string> syntheticLines(size_t numLines, int numChannels)
+{
+	std::vector<std::string> lines;
+	const std::vector<double> samples = syntheticSamples(numLines);
+	for (size_t i = 0; i < numLines; i++)
+	{
+		char buffer[64];
+		snprintf(buffer, sizeof(buffer), "y%d=%.6g", int(i % numChannels), samples[i]);
+		lines.push_back(buffer);
+	}
+	return lines;
+}
+
+int main(int argc, char* argv[])
+{
+	std::string testInputFileName = "test_input.txt";
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--csv") == 0)
+		{
+			csvOutput = true;
+		}
+		else
+		{
+			testInputFileName = argv[i];
+		}
+	}
+
+	if (csvOutput)
+	{
+		printf("benchmark,samples,ns_per_sample,bytes_per_sample\n");
+	}
+	else
+	{
+		printf("%-40s %10s %12s %12s\n", "benchmark", "samples", "ns/sample", "bytes/sample");
+	}
+
+	const size_t sizes[] = { 1000, 10000, 100000 };
+	for (auto size : sizes)
+	{
+		benchStorages(size);
+		benchStorageDispatch(size);
+		benchStreamProcessors(size);
+	}
+	benchWorstCasePush(1 << 20);
+
+	std::vector<std::string> testInput;
+	{
+		std::ifstream in(testInputFileName.c_str());
+		std::string line;
+		while (getline(in, line))
+		{
+			testInput.push_back(line);
+		}
+	}
+	if (testInput.empty())
+	{
+		std::cerr << "WARNING: No lines read from \"" << testInputFileName << "\"\n";
+	}
+	else
+	{
+		PrefixMatcher matcher;
+		matcher.addPrefix("y=", 0);
+		benchParsing("test_input.txt", testInput, matcher);
+	}
+
+	const int numChannels = 4;
+	PrefixMatcher matcher;
+	for (int channel = 0; channel < numChannels; channel++)
+	{
+		matcher.addPrefix("y" + std::to_string(channel) + "=", channel);
+	}
+	for (auto size : sizes)
+	{
+		benchParsing("synthetic(4ch)", syntheticLines(size, numChannels), matcher);
+	}
+	for (auto size : sizes)
+	{
+		benchSplitting("synthetic(4ch) 1MiB reads", syntheticLines(size, numChannels), matcher, 1 << 20);
+	}
+	benchSplitting("synthetic(4ch) 4KiB reads", syntheticLines(100000, numChannels), matcher, 4096);
+
+	return 0;
+}
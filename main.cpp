@@ -20,19 +20,38 @@
 #include <string.h>
 
 #include "StreamProcessors/CappedPeakStorageWaveform.hpp"
+#include "StreamProcessors/CompressedStorageWaveform.hpp"
 #include "StreamProcessors/FIFOStorageWaveform.hpp"
+#include "StreamProcessors/LatencyHistogram.hpp"
+#include "StreamProcessors/LTTBDownsampler.hpp"
+#include "StreamProcessors/PersistenceStorageWaveform.hpp"
 #include "StreamProcessors/MinMaxCheck.hpp"
+#include "StreamProcessors/OverloadBuffer.hpp"
+#include "StreamProcessors/P2Quantile.hpp"
+#include "StreamProcessors/RunningStatistics.hpp"
 #include "StreamProcessors/SlidingAverager.hpp"
+#include "StreamProcessors/SpectrumAnalyzer.hpp"
+#include "StreamProcessors/StorageDispatch.hpp"
+#include "StreamProcessors/TriggerCapture.hpp"
+#include "StreamProcessors/XYDensityGrid.hpp"
+#include "BinaryFrame.hpp"
+#include "CaptureFile.hpp"
+#include "Harness.hpp"
+#include "InputMultiplexer.hpp"
+#include "LineParser.hpp"
+#include "MemoryBudget.hpp"
+#include "PerfCounters.hpp"
 #include "SDLWindow.hpp"
 #include "SDLEventHandler.hpp"
-
-#include <fstream>
+#include "OffscreenWindow.hpp"
+#include "WaveformExporter.hpp"
 
 #include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <getopt.h>
 #include <unistd.h>
+#include <signal.h>
 
 #include <iostream>
 #include <iomanip>
@@ -43,38 +62,116 @@
 #include <string>
 #include <thread>
 #include <mutex>
+#include <chrono>
+#include <functional>
+#include <memory>
 
 
 int verbose_flag = 0;
+int headless_flag = 0;
+int lttb_flag = 0;
+int harness_flag = 0;
+int binary_flag = 0;
+int stats_flag = 0;
+int overlay_flag = 0;
+int latency_flag = 0;
+int channel_stats_flag = 0;
+int auto_flag = 0;
 
 static std::atomic<bool> quit(false);
 
-struct Waveform {
-	Waveform() : peakWaveform(0)
+// Set by SIGUSR1 (or E in the window)
+static volatile sig_atomic_t exportRequested = 0;
+
+// With --channel-stats: of all samples stored of a channel
+struct ChannelStatistics {
+	ChannelStatistics() : p1(0.01), p50(0.5), p99(0.99)
 	{ }
-	~Waveform() {
-		delete peakWaveform;
-		peakWaveform = 0;
+	void push(double value)
+	{
+		if (value != value)
+		{
+			return; // NaN would poison the moments
+		}
+		moments.push(value);
+		p1.push(value);
+		p50.push(value);
+		p99.push(value);
 	}
-	Waveform (const Waveform& other) : prefix(other.prefix), peakWaveform(0)
+	RunningStatistics moments;
+	P2Quantile p1;
+	P2Quantile p50;
+	P2Quantile p99;
+};
+
+struct Waveform {
+	Waveform()
+	{ }
+	Waveform (const Waveform& other) :
+		prefix(other.prefix), unshownSince(other.unshownSince), statistics(other.statistics)
 	{
 		if (other.peakWaveform)
 		{
-			peakWaveform = other.peakWaveform->duplicate();
+			peakWaveform.reset(other.peakWaveform->duplicate());
 		}
 	}
 	Waveform& operator=(const Waveform& w)
 	{
 		prefix = w.prefix;
-		peakWaveform = peakWaveform->duplicate();
+		peakWaveform.reset(w.peakWaveform ? w.peakWaveform->duplicate() : 0);
+		unshownSince = w.unshownSince;
+		statistics = w.statistics;
 		return *this;
 	}
 	std::string prefix;
-	IWaveformStorage<double>*  peakWaveform;
+	std::unique_ptr<IWaveformStorage<double> > peakWaveform; // Of g_storage_kind
+
+	// With --latency: when the oldest sample not yet in a drawn frame was read
+	// (default constructed when there is none)
+	std::chrono::steady_clock::time_point unshownSince;
+
+	ChannelStatistics statistics; // Only updated with --channel-stats
 };
 
 std::vector<Waveform> g_waveforms;
-static std::mutex g_waveforms_mutex;
+
+// The channels in use, the first g_num_channels of g_waveforms. With --auto,
+// g_waveforms has room for more, and a channel is added (by the ingest
+// thread first seeing its key) by setting it up, and then publishing the
+// new count. Only reallocated before the threads start.
+static std::atomic<size_t> g_num_channels(0);
+static std::mutex g_add_channel_mutex; // Taken when adding channels
+
+static size_t numChannels()
+{
+	return g_num_channels.load(std::memory_order_acquire);
+}
+
+// The kind of all storages, set by the display mode
+static StorageKind g_storage_kind = StorageKind::CAPPED_PEAK;
+
+// Each channel has a lock of its own, so channels are stored (possibly by
+// different ingest threads) and copied for drawing independently.
+// g_waveforms[i] is protected by g_channel_locks[i].mutex.
+struct ChannelLock {
+	std::mutex mutex;
+	char padding[64]; // Keeps the locks of different channels on different cache lines
+};
+static std::unique_ptr<ChannelLock[]> g_channel_locks;
+
+// Only set in trigger mode. Sees the samples of all channels, so has a lock
+// of its own (taken after the one of the channel when storing samples).
+std::unique_ptr<TriggerCapture<double> > g_trigger; // Each channel of it under the lock of the channel
+
+// Only set with --harness
+std::unique_ptr<Harness> g_harness;
+
+// Only limited with --memory-limit. Only accounted by the display thread.
+static MemoryBudget g_memory_budget;
+// What each channel needs besides its storage (as estimated for the budget)
+static size_t g_fixed_bytes_per_channel = 0;
+// Of the compressed history of each channel in history mode (0 if unlimited)
+static size_t g_history_bytes_per_channel = 0;
 
 
 struct Axis {
@@ -114,10 +211,13 @@ enum DisplayMode {
 	SQUEZE,
 
 	ROLL_NY,
+	PERSIST,
+	HISTORY,
+	SPECTRUM,
 //	ROLL_TY,
 //	ROLL_XY,
 
-//	PLOT_XY,
+	PLOT_XY,
 //	PLOT_XYN,
 //	PLOT_XYT,
 };
@@ -126,6 +226,116 @@ DisplayMode displayMode = SQUEZE;
 
 int numSamples = 4096;
 
+int gridColumns = 740;
+int gridRows = 480;
+int gridDecayShift = 3;
+
+int frameDelayMs = 20;
+
+int fftSize = 1024;
+SpectrumAnalyzer::Window spectrumWindow = SpectrumAnalyzer::HANN;
+int spectrumAverages = 8;
+
+// In spectrum mode: the latest averaged spectrum of each channel (in dB, as
+// min = max points), published by the spectrum thread for drawing
+static std::vector<std::vector<MinMax<double> > > g_spectra;
+static std::mutex g_spectra_mutex;
+
+// In xy mode: the density of the points of the channel pairs (x from channel
+// 2i, y from channel 2i+1), and the last x of each pair (NaN until there is one)
+static std::unique_ptr<XYDensityGrid> g_xy_density;
+static std::vector<double> g_xy_last_x;
+static std::mutex g_xy_mutex;
+
+std::string frameDumpPrefix;
+int frameDumpInterval = 0;
+
+std::string exportPrefix = "export-";
+WaveformExporter::Format exportFormat = WaveformExporter::CSV;
+
+// What happens to samples arriving while the renderer holds the waveforms
+enum OverloadPolicy {
+	OVERLOAD_BLOCK,        // Wait for the lock (and eventually stall the writer)
+	OVERLOAD_DROP_OLDEST,
+	OVERLOAD_DROP_NEWEST,
+	OVERLOAD_DECIMATE,
+};
+
+OverloadPolicy overloadPolicy = OVERLOAD_BLOCK;
+
+// Samples held per channel while the lock is taken, with the non blocking policies
+const size_t overloadBufferSize = 4096;
+
+
+/**
+ * A storage for a channel, of the kind the display mode uses (g_storage_kind)
+ */
+IWaveformStorage<double>* newStorage()
+{
+	switch(displayMode)
+	{
+	case DisplayMode::SQUEZE:
+		return new CappedPeakStorageWaveform<double>(numSamples);
+	case DisplayMode::ROLL_NY:
+	case DisplayMode::SPECTRUM:
+	case DisplayMode::PLOT_XY:
+		return new FIFOStorageWaveform<double>(numSamples);
+	case DisplayMode::PERSIST:
+	{
+		PersistenceStorageWaveform<double>* persistence =
+				new PersistenceStorageWaveform<double>(numSamples, gridColumns, gridRows, gridDecayShift);
+		if (axis.isValidY())
+		{
+			persistence->setRange(axis.miny, axis.maxy);
+		}
+		return persistence;
+	}
+	case DisplayMode::HISTORY:
+		return new CompressedStorageWaveform<double>(numSamples, g_history_bytes_per_channel);
+	}
+	return 0;
+}
+
+/**
+ * Adds a channel found by --auto, if there is room for it in g_waveforms
+ * @return the channel, or KeyValueParser::NO_CHANNEL
+ */
+size_t addChannel(const std::string& prefix)
+{
+	std::lock_guard<std::mutex> guard(g_add_channel_mutex);
+	const size_t channel = g_num_channels.load(std::memory_order_relaxed);
+	if (channel == g_waveforms.size())
+	{
+		fprintf(stderr, "WARNING: No room for channel %s (see --max-channels)\n", prefix.c_str());
+		return KeyValueParser::NO_CHANNEL;
+	}
+	g_waveforms[channel].prefix = prefix;
+	g_waveforms[channel].peakWaveform.reset(newStorage());
+	g_num_channels.store(channel + 1, std::memory_order_release);
+	if (verbose_flag)
+	{
+		fprintf(stderr, "New channel %s\n", prefix.c_str());
+	}
+	return channel;
+}
+
+/**
+ * A sample of a channel in xy mode. Pairs it with the last x of the pair
+ * when it is a y.
+ */
+void pushXY(size_t channel, double value)
+{
+	std::lock_guard<std::mutex> guard(g_xy_mutex);
+	double& x = g_xy_last_x[channel / 2];
+	if (channel % 2 == 0)
+	{
+		x = value;
+	}
+	else if (x == x)
+	{
+		g_xy_density->push(x, value);
+	}
+}
 
 std::vector<double> getTickmarkSuggestion(double min, double max, int maxNumTicks = 10)
 {
@@ -169,127 +379,453 @@ std::vector<double> getTickmarkSuggestion(double min, double max, int maxNumTick
 }
 
 
-void sdlDisplayThread()
+/**
+ * Draws an IntensityGrid as a heat map into the screen rectangle starting at
+ * (left, top) of size width x height, which displays the values
+ * [viewMinX, viewMaxX] x [viewMinY, viewMaxY]. The grid itself covers the
+ * values [gridMinX, gridMaxX) x [gridMinY, gridMaxY).
+ */
+void drawIntensityGrid(IWindow& win, const IntensityGrid& grid,
+		int left, int top, int width, int height,
+		double viewMinX, double viewMaxX, double viewMinY, double viewMaxY,
+		double gridMinX, double gridMaxX, double gridMinY, double gridMaxY)
 {
-	SDLWindow win;
-	SDLEventHandler eventHandler;
-	while(!quit)
+	if (width <= 0 || height <= 0)
 	{
+		return;
+	}
+
+	const uint32_t maxCount = grid.getMaxCount();
+
+	// The log in countToRGB is too slow to do per pixel
+	std::vector<Uint32> palette(std::min<uint32_t>(maxCount, 4096) + 1);
+	for (uint32_t count = 0; count < palette.size(); count++)
+	{
+		palette[count] = IntensityGrid::countToRGB(count, maxCount);
+	}
+
+	std::vector<int> gridColumn(width);
+	for (int x = 0; x < width; x++)
+	{
+		double value = viewMinX + (x + 0.5) * (viewMaxX - viewMinX) / width;
+		gridColumn[x] = int(floor((value - gridMinX) * grid.getColumns() / (gridMaxX - gridMinX)));
+	}
+
+	std::vector<Uint32> image(width * height, 0);
+	for (int y = 0; y < height; y++)
+	{
+		double value = viewMaxY - (y + 0.5) * (viewMaxY - viewMinY) / height;
+		int row = int(floor((value - gridMinY) * grid.getRows() / (gridMaxY - gridMinY)));
+		if (row < 0 || row >= grid.getRows())
+		{
+			continue;
+		}
+
+		for (int x = 0; x < width; x++)
 		{
-			std::vector<Waveform> period_waveforms;
+			int column = gridColumn[x];
+			if (column < 0 || column >= grid.getColumns())
 			{
-				std::lock_guard<std::mutex> guard(g_waveforms_mutex);
-				period_waveforms = g_waveforms;
+				continue;
 			}
+			uint32_t count = grid.get(column, row);
+			image[y * width + x] = (count < palette.size()) ?
+					palette[count] : IntensityGrid::countToRGB(count, maxCount);
+		}
+	}
+
+	win.drawImage(left, top, width, height, &image[0]);
+}
 
-			// print last sample values along top of window
-			std::ostringstream oss;
-			oss << "ESC = quit, F11 = toggle fullscreen  [ ";
-			for (std::size_t i = 0; i < period_waveforms.size(); i++) {
-				oss << std::fixed << std::setprecision(2) << std::setw(5) << period_waveforms[i].peakWaveform->getLastSample();
-				oss << " ";
+/**
+ * Draws the xy mode density grid, zoomed in on the cells hit (or showing
+ * the --axis range), with tick marks along both axes
+ */
+void drawXYDensity(IWindow& win)
+{
+	std::unique_ptr<XYDensityGrid> density;
+	{
+		std::lock_guard<std::mutex> guard(g_xy_mutex);
+		density.reset(new XYDensityGrid(*g_xy_density));
+	}
+	const IntensityGrid& grid = density->getGrid();
+	const double cellWidth = (density->getRangeMaxX() - density->getRangeMinX()) / grid.getColumns();
+	const double cellHeight = (density->getRangeMaxY() - density->getRangeMinY()) / grid.getRows();
+
+	double viewMinX = density->getRangeMinX();
+	double viewMaxX = density->getRangeMaxX();
+	double viewMinY = density->getRangeMinY();
+	double viewMaxY = density->getRangeMaxY();
+	if (axis.isValidX() && axis.isValidY())
+	{
+		viewMinX = axis.minx;
+		viewMaxX = axis.maxx;
+		viewMinY = axis.miny;
+		viewMaxY = axis.maxy;
+	}
+	else
+	{
+		int firstColumn = grid.getColumns(), lastColumn = -1;
+		int firstRow = grid.getRows(), lastRow = -1;
+		for (int row = 0; row < grid.getRows(); row++)
+		{
+			for (int column = 0; column < grid.getColumns(); column++)
+			{
+				if (grid.get(column, row))
+				{
+					firstColumn = std::min(firstColumn, column);
+					lastColumn = std::max(lastColumn, column);
+					firstRow = std::min(firstRow, row);
+					lastRow = std::max(lastRow, row);
+				}
 			}
-			oss << "]";
-			win.drawString(0, 0, oss.str().c_str());
+		}
+		if (lastColumn >= 0)
+		{
+			viewMinX = density->getRangeMinX() + firstColumn * cellWidth;
+			viewMaxX = density->getRangeMinX() + (lastColumn + 1) * cellWidth;
+			viewMinY = density->getRangeMinY() + firstRow * cellHeight;
+			viewMaxY = density->getRangeMinY() + (lastRow + 1) * cellHeight;
+		}
+	}
+
+	const int leftPad = 60;
+	const int top = 29;
+	const int width = win.getWidth() - leftPad;
+	const int height = win.getHeight() - top;
+	drawIntensityGrid(win, grid, leftPad, top, width, height,
+			viewMinX, viewMaxX, viewMinY, viewMaxY,
+			density->getRangeMinX(), density->getRangeMaxX(), density->getRangeMinY(), density->getRangeMaxY());
+
+	for (const auto& y : getTickmarkSuggestion(viewMinY, viewMaxY, /*maxNumTicks*/ 10))
+	{
+		const int pixelY = top + int((viewMaxY - y) * (height - 1) / (viewMaxY - viewMinY));
+		win.drawLine(leftPad, pixelY, leftPad + 4, pixelY, 128, 128, 128, 255);
+		char buffer[200];
+		snprintf(buffer, sizeof(buffer), "%.2f", y);
+		win.drawString(0, pixelY, buffer);
+	}
+	for (const auto& x : getTickmarkSuggestion(viewMinX, viewMaxX, /*maxNumTicks*/ 8))
+	{
+		const int pixelX = leftPad + int((x - viewMinX) * (width - 1) / (viewMaxX - viewMinX));
+		if (pixelX < leftPad)
+		{
+			continue;
+		}
+		win.drawLine(pixelX, top + height - 5, pixelX, top + height - 1, 128, 128, 128, 255);
+		char buffer[200];
+		snprintf(buffer, sizeof(buffer), "%.2f", x);
+		win.drawString(pixelX + 2, top + height - 10, buffer);
+	}
+}
+
+/** One line of the --channel-stats panel */
+std::string channelStatisticsLine(const std::string& name, const ChannelStatistics& statistics)
+{
+	const RunningStatistics& moments = statistics.moments;
+	char line[256];
+	if (moments.getCount() == 0)
+	{
+		snprintf(line, sizeof(line), "%-12s n=0", name.c_str());
+	}
+	else
+	{
+		snprintf(line, sizeof(line), "%-12s n=%" PRIu64 " mean=%.5g sd=%.5g min=%.5g max=%.5g p1=%.5g p50=%.5g p99=%.5g",
+				name.c_str(), moments.getCount(), moments.getMean(), moments.getStdDev(),
+				moments.getMin(), moments.getMax(),
+				statistics.p1.getQuantile(), statistics.p50.getQuantile(), statistics.p99.getQuantile());
+	}
+	return line;
+}
 
+/**
+ * Draws all waveforms into win, but does NOT flip buffers
+ * @param overlayLines statistics to draw over the plot, or null
+ * @param shownSince if not null, gets when the oldest sample of each channel
+ *        drawn for the first time was read, and those samples count as shown
+ * @param showChannelStatistics draws the --channel-stats panel (below any overlay)
+ */
+void drawFrame(IWindow& win, const std::vector<std::string>* overlayLines = 0,
+		std::vector<std::chrono::steady_clock::time_point>* shownSince = 0,
+		bool showChannelStatistics = false)
+{
+	std::vector<Waveform> period_waveforms;
 
-			double signalMin = std::numeric_limits<double>::max();
-			double signalMax = std::numeric_limits<double>::min();
+	// Frozen trigger capture per channel (when there is one), converted to min/max pairs
+	std::vector<std::vector<MinMax<double> > > captured;
+	std::vector<size_t> capturedOffsets;
+	std::ostringstream triggerStatus;
 
-			for (auto & waveform : period_waveforms)
+	// In HISTORY mode, one min/max per pixel column over all of each history
+	std::vector<std::vector<MinMax<double> > > historyColumns;
+	{
+		PerfCounters::Clock::time_point snapshotStart = PerfCounters::Clock::now();
+		const size_t numShown = numChannels();
+		period_waveforms.reserve(numShown);
+		if (shownSince)
+		{
+			shownSince->resize(numShown);
+		}
+		const size_t numCaptures = g_trigger ? g_trigger->getNumCaptures() : 0;
+		for (size_t channel = 0; channel < numShown; channel++)
+		{
+			std::lock_guard<std::mutex> guard(g_channel_locks[channel].mutex);
+			period_waveforms.push_back(g_waveforms[channel]);
+			if (numCaptures)
 			{
-				const std::vector<MinMax<double> > & period_waveform = waveform.peakWaveform->getWaveform();
-				for (const auto& val : period_waveform)
+				const TriggerCapture<double>::Capture& capture = g_trigger->getCapture(channel);
+				captured.push_back(std::vector<MinMax<double> >());
+				capturedOffsets.push_back(capture.offset);
+				for (const auto& sample : capture.samples)
 				{
-					if (val.min < signalMin) { signalMin = val.min; }
-					if (val.max > signalMax) { signalMax = val.max; }
+					captured.back().push_back(MinMax<double>(sample, sample));
 				}
 			}
-
-			// If external constraints on axis, follow those
-			if (axis.isValidY())
+			if (shownSince)
 			{
-				signalMin = axis.miny;
-				signalMax = axis.maxy;
+				(*shownSince)[channel] = g_waveforms[channel].unshownSince;
+				g_waveforms[channel].unshownSince = std::chrono::steady_clock::time_point();
 			}
+		}
+
+		if (g_trigger)
+		{
+			triggerStatus << "  TRIG " << g_waveforms[g_trigger->getTriggerChannel()].prefix
+					<< (g_trigger->getEdge() == TriggerCapture<double>::RISING ? " rising " : " falling ")
+					<< g_trigger->getLevel() << " #" << numCaptures;
+		}
+		PerfCounters::add(PerfCounters::SNAPSHOTS);
+		PerfCounters::addTime(PerfCounters::SNAPSHOT_NS, PerfCounters::Clock::now() - snapshotStart);
+	}
+
+	// From the copies (which share the compressed blocks), without any lock held
+	if (displayMode == DisplayMode::HISTORY)
+	{
+		historyColumns.resize(period_waveforms.size());
+		for (size_t channel = 0; channel < period_waveforms.size(); channel++)
+		{
+			static_cast<const CompressedStorageWaveform<double>&>(*period_waveforms[channel].peakWaveform)
+					.getColumns(std::max(1, win.getWidth() - 60), historyColumns[channel]);
+		}
+	}
+	const bool showCapture = !captured.empty();
 
+	// Drawn first, as it covers all of the plot
+	const bool showXY = displayMode == DisplayMode::PLOT_XY && !showCapture;
+	if (showXY)
+	{
+		drawXYDensity(win);
+	}
 
-			bool ticsWasDrawn = false;
+	std::vector<std::vector<MinMax<double> > > spectra;
+	if (displayMode == DisplayMode::SPECTRUM)
+	{
+		std::lock_guard<std::mutex> guard(g_spectra_mutex);
+		spectra = g_spectra;
+		spectra.resize(period_waveforms.size());
+	}
 
-			for (auto & waveform : period_waveforms)
-			{
-				const std::vector<MinMax<double> > & period_waveform = waveform.peakWaveform->getWaveform();
+	// print last sample values along top of window
+	std::ostringstream oss;
+	oss << "ESC = quit, F11 = toggle fullscreen, S = stats, E = export  [ ";
+	for (std::size_t i = 0; i < period_waveforms.size(); i++) {
+		oss << std::fixed << std::setprecision(2) << std::setw(5) << period_waveforms[i].peakWaveform->getLastSample();
+		oss << " ";
+	}
+	oss << "]";
+	oss << triggerStatus.str();
+	win.drawString(0, 0, oss.str().c_str());
 
-				int width = win.getWidth();
-				int height = win.getHeight();
+	size_t numPanelLines = 0;
+	if (overlayLines)
+	{
+		for (const auto& line : *overlayLines)
+		{
+			win.drawString(70, 14 + 10 * numPanelLines++, line.c_str());
+		}
+	}
+	if (showChannelStatistics)
+	{
+		for (const auto& waveform : period_waveforms)
+		{
+			win.drawString(70, 14 + 10 * numPanelLines++,
+					channelStatisticsLine(waveform.prefix, waveform.statistics).c_str());
+		}
+	}
+	if (showXY)
+	{
+		return;
+	}
 
-				const auto & convertY = [&](double sample) {
-					double tmp = (sample - signalMin) * (height-30) * 1.0 / (signalMax - signalMin);
-					return height - 1 - tmp;
-				};
-				const auto & convertX = [&](double x) {
-					int leftPad = 60;
-					double tmp;
-					if (displayMode == DisplayMode::ROLL_NY)
-						tmp = x * (width - leftPad) *1.0 / numSamples;
-					else
-						tmp = x * (width - leftPad) *1.0 / period_waveform.size();
-					return leftPad + tmp;
-				};
+	const auto & getShownWaveform = [&](size_t channel) -> const std::vector<MinMax<double> > & {
+		if (showCapture)
+			return captured[channel];
+		if (displayMode == DisplayMode::SPECTRUM)
+			return spectra[channel];
+		if (displayMode == DisplayMode::HISTORY)
+			return historyColumns[channel];
+		return period_waveforms[channel].peakWaveform->getWaveform();
+	};
 
 
-				if (!ticsWasDrawn)
-				{
-					//
-					// Draw horizontal help lines
-					//
-					const std::vector<double> tics =
-							getTickmarkSuggestion(signalMin, signalMax, /*maxNumTicks*/ 10);
+	double signalMin = std::numeric_limits<double>::max();
+	double signalMax = std::numeric_limits<double>::lowest();
 
-					for (const auto& y : tics)
-					{
-						win.drawLine(
-								convertX(0),
-								convertY(y),
-								width - 1,
-								convertY(y),
-								64, 64, 64, 255
-						);
-						char buffer[200];
-						snprintf(buffer, sizeof(buffer), "%.2f", y);
-
-						win.drawString(0, convertY(y), buffer);
-					}
+	for (size_t channel = 0; channel < period_waveforms.size(); channel++)
+	{
+		const std::vector<MinMax<double> > & period_waveform = getShownWaveform(channel);
+		for (const auto& val : period_waveform)
+		{
+			if (val.min < signalMin) { signalMin = val.min; }
+			if (val.max > signalMax) { signalMax = val.max; }
+		}
+	}
 
-					ticsWasDrawn = true;
-				}
+	// If external constraints on axis, follow those
+	if (axis.isValidY())
+	{
+		signalMin = axis.miny;
+		signalMax = axis.maxy;
+	}
 
 
-				for (int i = 0; i < int(period_waveform.size())-1; i++)
-				{
-					if (displayMode == DisplayMode::SQUEZE)
-					{
-						win.drawLine(
-								convertX(i),
-								convertY(period_waveform[i].min),
-								convertX(i),
-								convertY(period_waveform[i].max),
-								255, 255, 255, 255
-						);
-					}
-					else if (displayMode == DisplayMode::ROLL_NY)
-					{
-						int emptySamples = numSamples-period_waveform.size();
-						win.drawLine(
-								convertX(i + emptySamples),
-								convertY(period_waveform[i].min),
-								convertX(i + emptySamples),
-								convertY(period_waveform[i].max),
-								255, 255, 255, 255
-						);
-					}
-				}
-				
+	bool ticsWasDrawn = false;
+
+	for (size_t channel = 0; channel < period_waveforms.size(); channel++)
+	{
+		const Waveform & waveform = period_waveforms[channel];
+		const std::vector<MinMax<double> > & period_waveform = getShownWaveform(channel);
+
+		int width = win.getWidth();
+		int height = win.getHeight();
+
+		// The waveform starts emptySamples positions into a plot spanning samplesAcross positions
+		int emptySamples = 0;
+		int samplesAcross = period_waveform.size();
+		if (showCapture)
+		{
+			emptySamples = capturedOffsets[channel];
+			samplesAcross = g_trigger->getWindowSize();
+		}
+		else if (displayMode == DisplayMode::ROLL_NY)
+		{
+			emptySamples = numSamples-period_waveform.size();
+			samplesAcross = numSamples;
+		}
+
+		const auto & convertY = [&](double sample) {
+			double tmp = (sample - signalMin) * (height-30) * 1.0 / (signalMax - signalMin);
+			return height - 1 - tmp;
+		};
+		const auto & convertX = [&](double x) {
+			int leftPad = 60;
+			double tmp = x * (width - leftPad) *1.0 / samplesAcross;
+			return leftPad + tmp;
+		};
+
+
+		if (!ticsWasDrawn)
+		{
+			//
+			// Draw horizontal help lines
+			//
+			const std::vector<double> tics =
+					getTickmarkSuggestion(signalMin, signalMax, /*maxNumTicks*/ 10);
+
+			for (const auto& y : tics)
+			{
+				win.drawLine(
+						convertX(0),
+						convertY(y),
+						width - 1,
+						convertY(y),
+						64, 64, 64, 255
+				);
+				char buffer[200];
+				snprintf(buffer, sizeof(buffer), "%.2f", y);
+
+				win.drawString(0, convertY(y), buffer);
+			}
+
+			if (showCapture)
+			{
+				// Mark trigger position and level
+				win.drawLine(
+						convertX(g_trigger->getPreTriggerSamples()),
+						convertY(signalMax),
+						convertX(g_trigger->getPreTriggerSamples()),
+						convertY(signalMin),
+						160, 64, 64, 255
+				);
+				win.drawLine(
+						convertX(0),
+						convertY(g_trigger->getLevel()),
+						width - 1,
+						convertY(g_trigger->getLevel()),
+						160, 64, 64, 255
+				);
+			}
+
+			ticsWasDrawn = true;
+		}
+
+		if (displayMode == DisplayMode::PERSIST && !showCapture)
+		{
+			const auto & persistence =
+					static_cast<const PersistenceStorageWaveform<double>&>(*waveform.peakWaveform);
+			int top = convertY(signalMax);
+			drawIntensityGrid(win, persistence.getGrid(),
+					convertX(0), top, width - convertX(0), height - top,
+					0, 1, signalMin, signalMax,
+					0, 1, persistence.getRangeMin(), persistence.getRangeMax());
+			continue;
+		}
+
+		if (displayMode == DisplayMode::SPECTRUM && !showCapture)
+		{
+			// Bins from 0 to half the sample rate, as a line
+			for (int i = 0; i < int(period_waveform.size())-1; i++)
+			{
+				win.drawLine(
+						convertX(i),
+						convertY(period_waveform[i].max),
+						convertX(i+1),
+						convertY(period_waveform[i+1].max),
+						255, 255, 255, 255
+				);
+			}
+			continue;
+		}
+
+		if (lttb_flag)
+		{
+			// About two points per pixel column is enough to keep the shape
+			static LTTBDownsampler<double> downsampler;
+			const auto & points = downsampler.downsample(period_waveform, 2 * (width - convertX(0)));
+			for (int i = 0; i < int(points.size())-1; i++)
+			{
+				win.drawLine(
+						convertX(points[i].x + emptySamples),
+						convertY(points[i].y),
+						convertX(points[i+1].x + emptySamples),
+						convertY(points[i+1].y),
+						255, 255, 255, 255
+				);
+			}
+			continue;
+		}
+
+		for (int i = 0; i < int(period_waveform.size())-1; i++)
+		{
+			win.drawLine(
+					convertX(i + emptySamples),
+					convertY(period_waveform[i].min),
+					convertX(i + emptySamples),
+					convertY(period_waveform[i].max),
+					255, 255, 255, 255
+			);
+		}
+		
 //				for (int i = 0; i < int(period_waveform.size())-1; i++)
 //				{
 //					win.drawLine(
@@ -300,79 +836,472 @@ void sdlDisplayThread()
 //							32, 32, 255, 255
 //					);
 //				}
-				
-				for (int i = 0; i < int(period_waveform.size())-1; i++)
-				{
-					if (displayMode == DisplayMode::SQUEZE)
-					{
-						win.drawLine(
-								convertX(i),
-								convertY(period_waveform[i].max),
-								convertX(i+1),
-								convertY(period_waveform[i+1].max),
-								255, 255, 255, 255
-						);
-					}
-					else if (displayMode == DisplayMode::ROLL_NY)
-					{
-						int emptySamples = numSamples-period_waveform.size();
-						win.drawLine(
-								convertX(i + emptySamples),
-								convertY(period_waveform[i].max),
-								convertX(i+1 + emptySamples),
-								convertY(period_waveform[i+1].max),
-								255, 255, 255, 255
-						);
-					}
-
-
-				}
-			}
+		
+		for (int i = 0; i < int(period_waveform.size())-1; i++)
+		{
+			win.drawLine(
+					convertX(i + emptySamples),
+					convertY(period_waveform[i].max),
+					convertX(i+1 + emptySamples),
+					convertY(period_waveform[i+1].max),
+					255, 255, 255, 255
+			);
 		}
+	}
+}
 
-		win.flip();
-		win.clear();
-		usleep(20000);
-
-		eventHandler.refresh();
+void printLatency(FILE* f, const LatencyHistogram& latency)
+{
+	fprintf(f, "Latency from reading a sample to flipping the first frame showing it"
+			" (oldest new sample per channel and frame):\n");
+	if (latency.getCount() == 0)
+	{
+		fprintf(f, "  no samples shown yet\n");
+		return;
+	}
+	fprintf(f, "  %llu measurements, min %.3f ms, mean %.3f ms\n",
+			(unsigned long long)latency.getCount(), latency.getMin() / 1e6, latency.getMean() / 1e6);
+	fprintf(f, "  p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, p99.9 %.3f ms, max %.3f ms\n",
+			latency.getPercentile(50) / 1e6, latency.getPercentile(90) / 1e6,
+			latency.getPercentile(99) / 1e6, latency.getPercentile(99.9) / 1e6,
+			latency.getMax() / 1e6);
+}
 
-		if (eventHandler.shouldQuit())
+/**
+ * Copies the storages (which is all the channel locks are held for), and
+ * leaves the writing to the exporter thread
+ */
+void exportWaveforms(WaveformExporter& exporter)
+{
+	std::vector<WaveformExporter::Channel> channels;
+	channels.resize(numChannels());
+	for (size_t i = 0; i < channels.size(); i++)
+	{
+		std::lock_guard<std::mutex> guard(g_channel_locks[i].mutex);
+		channels[i].name = g_waveforms[i].prefix;
+		if (displayMode == DisplayMode::HISTORY)
 		{
-			quit = true;
+			// Shares the compressed blocks. Every sample is decoded by the exporter thread
+			channels[i].history.reset(
+					static_cast<CompressedStorageWaveform<double>*>(g_waveforms[i].peakWaveform->duplicate()));
 		}
-
-
-		bool wantFullscreen = eventHandler.shouldGoFullscreen();
-		bool isFullscreen = win.isFullscreen();
-		if (wantFullscreen != isFullscreen)
+		else
 		{
-			win.setFullscreenMode(wantFullscreen);
+			channels[i].waveform = g_waveforms[i].peakWaveform->getWaveform();
 		}
 	}
+
+	if (!exporter.exportSnapshot(channels))
+	{
+		fprintf(stderr, "WARNING: Skipping export, as the previous one is still being written\n");
+	}
 }
 
-int main (int argc, char *argv[])
+void requestExport(int)
 {
-  std::string inputFileName = "/dev/stdin";
-  std::string xPrefix;
-  std::map<std::string, size_t> yPrefixes;
+	exportRequested = 1;
+}
 
-  int showHelp_flag = 0;
+// Headless, inputs such as sockets may never end. SIGINT or SIGTERM ends
+// the run as if they had (a second one kills as usual).
+void requestQuit(int)
+{
+	quit = true;
+}
 
-  while(true)
-  {
-	  int c;
-	  static struct option long_options[] =
-        {
-          /* These options set a flag. */
-          {"verbose", no_argument,   &verbose_flag, 1},
-          {"brief",   no_argument,   &verbose_flag, 0},
-          {"help",    no_argument,   &showHelp_flag, 1},
-          /* These options don’t set a flag.
-             We distinguish them by their indices. */
-          {"file",    required_argument, 0, 'f'},
+/**
+ * Accounts what the storages (and the copies drawn of them) use against
+ * the memory limit, and shrinks them by a quarter when over it
+ */
+void accountMemory()
+{
+	const size_t numAccounted = numChannels();
+	size_t used = numAccounted * g_fixed_bytes_per_channel;
+	for (size_t i = 0; i < numAccounted; i++)
+	{
+		std::lock_guard<std::mutex> guard(g_channel_locks[i].mutex);
+		const IWaveformStorage<double>& storage = *g_waveforms[i].peakWaveform;
+		used += storage.memoryUsage() + storage.getWaveform().size() * sizeof(MinMax<double>);
+	}
+	g_memory_budget.setUsed(used);
+
+	// The persistence grid and the spectrum windows do not shrink
+	if (!g_memory_budget.isExceeded() || displayMode == DisplayMode::PERSIST ||
+		displayMode == DisplayMode::SPECTRUM || numSamples <= 2)
+	{
+		return;
+	}
+	// Channels added from here on get the new size
+	std::lock_guard<std::mutex> addGuard(g_add_channel_mutex);
+	numSamples = std::max(2, (numSamples / 4 * 3) & ~1);
+	for (size_t i = 0; i < numChannels(); i++)
+	{
+		std::lock_guard<std::mutex> guard(g_channel_locks[i].mutex);
+		g_waveforms[i].peakWaveform->setCapacity(numSamples);
+	}
+	fprintf(stderr, "WARNING: %.1f MB used, over the memory limit. Now keeping %d points per channel\n",
+			used / 1e6, numSamples);
+}
+
+void printChannelStatistics(FILE* f)
+{
+	const size_t numPrinted = numChannels();
+	for (size_t i = 0; i < numPrinted; i++)
+	{
+		std::lock_guard<std::mutex> guard(g_channel_locks[i].mutex);
+		fprintf(f, "%s\n", channelStatisticsLine(g_waveforms[i].prefix, g_waveforms[i].statistics).c_str());
+	}
+	fprintf(f, "\n");
+}
+
+/**
+ * Adds the latest window of samples of each channel to its analyzer, once
+ * at least a quarter of a window of new samples arrived, and publishes the
+ * spectra to g_spectra
+ * @param numAnalyzed samples of each channel when last analyzed
+ */
+void updateSpectra(std::vector<SpectrumAnalyzer>& analyzers, std::vector<uint64_t>& numAnalyzed)
+{
+	const PerfCounters::Snapshot counters = PerfCounters::read();
+	std::vector<double> samples;
+	std::vector<double> magnitudes;
+	const size_t numInUse = std::min(analyzers.size(), numChannels());
+	for (size_t channel = 0; channel < numInUse; channel++)
+	{
+		SpectrumAnalyzer& analyzer = analyzers[channel];
+		const uint64_t numStored = counters.getSamples(channel);
+		if (numStored - numAnalyzed[channel] < analyzer.getSize() / 4)
+		{
+			continue;
+		}
+		{
+			std::lock_guard<std::mutex> guard(g_channel_locks[channel].mutex);
+			const auto & waveform = g_waveforms[channel].peakWaveform->getWaveform();
+			if (waveform.size() < analyzer.getSize())
+			{
+				continue;
+			}
+			samples.resize(analyzer.getSize());
+			for (size_t i = 0; i < samples.size(); i++)
+			{
+				samples[i] = waveform[waveform.size() - samples.size() + i].max;
+			}
+		}
+		numAnalyzed[channel] = numStored;
+
+		analyzer.add(&samples[0]);
+		analyzer.getMagnitudesDb(magnitudes);
+
+		std::lock_guard<std::mutex> guard(g_spectra_mutex);
+		g_spectra.resize(analyzers.size());
+		g_spectra[channel].resize(magnitudes.size());
+		for (size_t bin = 0; bin < magnitudes.size(); bin++)
+		{
+			g_spectra[channel][bin] = MinMax<double>(magnitudes[bin], magnitudes[bin]);
+		}
+	}
+}
+
+/**
+ * Computes the spectra in spectrum mode, off the render thread, until stop is set
+ */
+void spectrumThread(const std::atomic<bool>& stop)
+{
+	std::vector<SpectrumAnalyzer> analyzers(g_waveforms.size(),
+			SpectrumAnalyzer(fftSize, spectrumWindow, spectrumAverages));
+	std::vector<uint64_t> numAnalyzed(g_waveforms.size(), 0);
+	while (!stop)
+	{
+		updateSpectra(analyzers, numAnalyzed);
+		usleep(frameDelayMs * 1000);
+	}
+	// A last time, for whatever arrived since
+	updateSpectra(analyzers, numAnalyzed);
+}
+
+/**
+ * Renders frames until quit is set.
+ * @param eventHandler may be null when there is no display to take events from
+ * @return total time spent drawing and flipping frames (excluding delays)
+ */
+std::chrono::steady_clock::duration displayLoop(IWindow& win, SDLEventHandler* eventHandler)
+{
+	// The prefix of a channel in use doesn't change
+	std::vector<std::string> channelNames;
+	const auto & updateChannelNames = [&]() {
+		for (size_t channel = channelNames.size(); channel < numChannels(); channel++)
+		{
+			channelNames.push_back(g_waveforms[channel].prefix);
+		}
+	};
+	updateChannelNames();
+	PerfReport perfReport(channelNames);
+	bool showOverlay = overlay_flag;
+	bool showChannelStatistics = channel_stats_flag;
+
+	LatencyHistogram latency;
+	std::vector<std::chrono::steady_clock::time_point> shownSince;
+
+	// Waits for the last export to be written when leaving
+	WaveformExporter exporter(exportPrefix, exportFormat);
+
+	std::thread spectrum;
+	if (displayMode == DisplayMode::SPECTRUM)
+	{
+		spectrum = std::thread(spectrumThread, std::cref(quit));
+	}
+
+	std::chrono::steady_clock::duration renderTime(0);
+	while(!quit)
+	{
+		std::chrono::steady_clock::time_point renderStart = std::chrono::steady_clock::now();
+
+		drawFrame(win, showOverlay ? &perfReport.getLines() : 0, latency_flag ? &shownSince : 0,
+				showChannelStatistics);
+		win.flip();
+
+		if (latency_flag)
+		{
+			std::chrono::steady_clock::time_point flipTime = std::chrono::steady_clock::now();
+			for (const auto& readTime : shownSince)
+			{
+				if (readTime != std::chrono::steady_clock::time_point())
+				{
+					latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(flipTime - readTime).count());
+				}
+			}
+		}
+
+		win.clear();
+		std::chrono::steady_clock::duration frameTime = std::chrono::steady_clock::now() - renderStart;
+		renderTime += frameTime;
+		if (g_harness)
+		{
+			g_harness->frameRendered(frameTime);
+		}
+		PerfCounters::add(PerfCounters::FRAMES);
+		PerfCounters::addTime(PerfCounters::FRAME_NS, frameTime);
+
+		if (channelNames.size() != numChannels())
+		{
+			updateChannelNames();
+			perfReport.setChannelNames(channelNames);
+		}
+		if (perfReport.update())
+		{
+			if (g_memory_budget.isLimited())
+			{
+				accountMemory();
+				perfReport.setAccountedMemory(g_memory_budget.getUsed(), g_memory_budget.getLimit());
+			}
+			if (stats_flag)
+			{
+				perfReport.print(stderr);
+				if (channel_stats_flag)
+				{
+					printChannelStatistics(stderr);
+				}
+			}
+		}
+
+		usleep(frameDelayMs * 1000);
+
+		if (eventHandler)
+		{
+			eventHandler->refresh();
+			if (eventHandler->getExportRequest())
+			{
+				exportRequested = 1;
+			}
+		}
+
+		if (exportRequested)
+		{
+			exportRequested = 0;
+			exportWaveforms(exporter);
+		}
+
+		if (!eventHandler)
+		{
+			continue;
+		}
+
+		if (eventHandler->shouldQuit())
+		{
+			quit = true;
+		}
+
+
+		if (eventHandler->getLatencyDumpRequest() && latency_flag)
+		{
+			printLatency(stderr, latency);
+		}
+
+		showOverlay = eventHandler->shouldShowStats();
+		showChannelStatistics = channel_stats_flag && eventHandler->shouldShowChannelStats();
+		PerfCounters::setEnabled(stats_flag || showOverlay);
+
+		bool wantFullscreen = eventHandler->shouldGoFullscreen();
+		bool isFullscreen = win.isFullscreen();
+		if (wantFullscreen != isFullscreen)
+		{
+			win.setFullscreenMode(wantFullscreen);
+		}
+
+		// Everything drawn is derived from the storages and the window size
+		// each frame, so nothing besides the frame buffer needs rebuilding.
+		// The persist and xy mode grids keep their --grid size, and are
+		// scaled to the plot area when drawn.
+		int w, h;
+		if (eventHandler->getResizeRequest(w, h))
+		{
+			win.resize(w, h);
+		}
+	}
+
+	if (latency_flag)
+	{
+		printLatency(stderr, latency);
+	}
+	if (channel_stats_flag)
+	{
+		printChannelStatistics(stderr);
+	}
+	if (spectrum.joinable())
+	{
+		spectrum.join();
+	}
+	return renderTime;
+}
+
+void sdlDisplayThread()
+{
+	SDLWindow win;
+	SDLEventHandler eventHandler(overlay_flag);
+	displayLoop(win, &eventHandler);
+}
+
+void offscreenDisplayThread()
+{
+	OffscreenWindow win;
+	win.setFrameDump(frameDumpPrefix, frameDumpInterval);
+
+	double renderSeconds = std::chrono::duration<double>(displayLoop(win, 0)).count();
+	size_t numFrames = win.getNumFlippedFrames();
+
+	// Batch jobs are mostly interested in the plot of all data
+	if (!frameDumpPrefix.empty())
+	{
+		drawFrame(win);
+		win.writePPM(frameDumpPrefix + "last.ppm");
+	}
+
+	fprintf(stderr, "Rendered %zu frames in %.3f s", numFrames, renderSeconds);
+	if (renderSeconds > 0)
+	{
+		fprintf(stderr, " (%.1f frames/s, %.3f ms/frame)",
+				numFrames / renderSeconds, 1000.0 * renderSeconds / numFrames);
+	}
+	fprintf(stderr, "\n");
+}
+
+/* Values returned by getopt_long for options only having a long form. */
+enum LongOnlyOption {
+	OPT_DUMP_FRAMES = 256,
+	OPT_DUMP_INTERVAL,
+	OPT_FRAME_DELAY,
+	OPT_GRID,
+	OPT_DECAY,
+	OPT_TRIGGER,
+	OPT_TRIGGER_SAMPLES,
+	OPT_PRETRIGGER,
+	OPT_OVERLOAD,
+	OPT_RECORD,
+	OPT_REPLAY,
+	OPT_SPEED,
+	OPT_EXPORT_PREFIX,
+	OPT_EXPORT_FORMAT,
+	OPT_COLUMNS,
+	OPT_DELIMITER,
+	OPT_INGEST_THREADS,
+	OPT_MEMORY_LIMIT,
+	OPT_FFT_SIZE,
+	OPT_WINDOW,
+	OPT_AVERAGE,
+	OPT_MAX_CHANNELS,
+};
+
+int main (int argc, char *argv[])
+{
+  std::vector<std::string> inputFileNames;
+  std::string xPrefix;
+  std::map<std::string, size_t> yPrefixes;
+  std::vector<size_t> numInputsBeforeChannel;
+
+  int showHelp_flag = 0;
+
+  std::string triggerSetting;
+  int triggerSamples = 1000;
+  int preTriggerPercent = 50;
+
+  std::string recordFileName;
+  std::string replayFileName;
+  double replaySpeed = 1;
+
+  int ingestThreads = 1;
+
+  bool numSamplesSet = false;
+
+  size_t maxChannels = 64; // With --auto
+
+  std::vector<size_t> columns; // counting from 0, with --columns
+  char delimiter = 0;          // 0 for runs of spaces and tabs
+
+  while(true)
+  {
+	  int c;
+	  static struct option long_options[] =
+        {
+          /* These options set a flag. */
+          {"verbose", no_argument,   &verbose_flag, 1},
+          {"brief",   no_argument,   &verbose_flag, 0},
+          {"help",    no_argument,   &showHelp_flag, 1},
+          {"headless", no_argument,  &headless_flag, 1},
+          {"lttb",     no_argument,  &lttb_flag, 1},
+          {"harness",  no_argument,  &harness_flag, 1},
+          {"binary",   no_argument,  &binary_flag, 1},
+          {"stats",    no_argument,  &stats_flag, 1},
+          {"overlay",  no_argument,  &overlay_flag, 1},
+          {"latency",  no_argument,  &latency_flag, 1},
+          {"channel-stats", no_argument, &channel_stats_flag, 1},
+          {"auto",     no_argument,  &auto_flag, 1},
+          /* These options don’t set a flag.
+             We distinguish them by their indices. */
+          {"file",    required_argument, 0, 'f'},
 		  {"axis",    required_argument, 0, 'a'},
 		  {"mode",    required_argument, 0, 'm'},
+		  {"dump-frames",   required_argument, 0, OPT_DUMP_FRAMES},
+		  {"dump-interval", required_argument, 0, OPT_DUMP_INTERVAL},
+		  {"frame-delay",   required_argument, 0, OPT_FRAME_DELAY},
+		  {"grid",          required_argument, 0, OPT_GRID},
+		  {"decay",         required_argument, 0, OPT_DECAY},
+		  {"trigger",         required_argument, 0, OPT_TRIGGER},
+		  {"trigger-samples", required_argument, 0, OPT_TRIGGER_SAMPLES},
+		  {"pretrigger",      required_argument, 0, OPT_PRETRIGGER},
+		  {"overload",        required_argument, 0, OPT_OVERLOAD},
+		  {"record",          required_argument, 0, OPT_RECORD},
+		  {"replay",          required_argument, 0, OPT_REPLAY},
+		  {"speed",           required_argument, 0, OPT_SPEED},
+		  {"export-prefix",   required_argument, 0, OPT_EXPORT_PREFIX},
+		  {"export-format",   required_argument, 0, OPT_EXPORT_FORMAT},
+		  {"columns",         required_argument, 0, OPT_COLUMNS},
+		  {"delimiter",       required_argument, 0, OPT_DELIMITER},
+		  {"ingest-threads",  required_argument, 0, OPT_INGEST_THREADS},
+		  {"memory-limit",    required_argument, 0, OPT_MEMORY_LIMIT},
+		  {"fft-size",        required_argument, 0, OPT_FFT_SIZE},
+		  {"window",          required_argument, 0, OPT_WINDOW},
+		  {"average",         required_argument, 0, OPT_AVERAGE},
+		  {"max-channels",    required_argument, 0, OPT_MAX_CHANNELS},
           {0, 0, 0, 0}
         };
       /* getopt_long stores the option index here. */
@@ -403,33 +1332,302 @@ int main (int argc, char *argv[])
         	is >> axis.minx >> axis.maxx >> axis.miny >> axis.maxy;
         	if ((!is.eof()) || (!is))
         	{
-        		std::cout << "ERROR: Unable to parse axis settings \"" << optarg << "\"\n";
+        		std::cout << "ERROR: Unable to parse axis settings \"" << optarg << "\"\n";
+        		return 1;
+        	}
+        	break;
+        }
+
+        case 'm':
+        {
+        	// --mode squeze|roll_ny|persist|history|spectrum|xy
+        	if (strcmp("squeze", optarg) == 0)
+        	{
+        		displayMode = DisplayMode::SQUEZE;
+        	}
+        	else if (strcmp("roll_ny", optarg) == 0)
+        	{
+        		displayMode = DisplayMode::ROLL_NY;
+        	}
+        	else if (strcmp("persist", optarg) == 0)
+        	{
+        		displayMode = DisplayMode::PERSIST;
+        	}
+        	else if (strcmp("history", optarg) == 0)
+        	{
+        		displayMode = DisplayMode::HISTORY;
+        	}
+        	else if (strcmp("spectrum", optarg) == 0)
+        	{
+        		displayMode = DisplayMode::SPECTRUM;
+        	}
+        	else if (strcmp("xy", optarg) == 0)
+        	{
+        		displayMode = DisplayMode::PLOT_XY;
+        	}
+        	break;
+        }
+
+        case 'n':
+        {
+        	std::istringstream is(optarg);
+        	is >> numSamples;
+        	if ((!is.eof()) || (!is))
+        	{
+        		std::cout << "ERROR: Unable to parse -n setting \"" << optarg << "\"\n";
+        		return 1;
+        	}
+        	numSamplesSet = true;
+        	break;
+        }
+
+        case OPT_DUMP_FRAMES:
+        	frameDumpPrefix = optarg;
+        	if (frameDumpInterval == 0)
+        	{
+        		frameDumpInterval = 1;
+        	}
+        	break;
+
+        case OPT_DUMP_INTERVAL:
+        {
+        	std::istringstream is(optarg);
+        	is >> frameDumpInterval;
+        	if ((!is.eof()) || (!is) || frameDumpInterval < 0)
+        	{
+        		std::cout << "ERROR: Unable to parse --dump-interval setting \"" << optarg << "\"\n";
+        		return 1;
+        	}
+        	break;
+        }
+
+        case OPT_FRAME_DELAY:
+        {
+        	std::istringstream is(optarg);
+        	is >> frameDelayMs;
+        	if ((!is.eof()) || (!is) || frameDelayMs < 0)
+        	{
+        		std::cout << "ERROR: Unable to parse --frame-delay setting \"" << optarg << "\"\n";
+        		return 1;
+        	}
+        	break;
+        }
+
+        case OPT_GRID:
+        {
+        	// --grid WxH
+        	char separator = 0;
+        	std::istringstream is(optarg);
+        	is >> gridColumns >> separator >> gridRows;
+        	if ((!is.eof()) || (!is) || separator != 'x' ||
+        		gridColumns <= 0 || gridRows <= 0 || (gridRows & 1))
+        	{
+        		std::cout << "ERROR: Unable to parse --grid setting \"" << optarg << "\" (height must be even)\n";
+        		return 1;
+        	}
+        	break;
+        }
+
+        case OPT_DECAY:
+        {
+        	std::istringstream is(optarg);
+        	is >> gridDecayShift;
+        	if ((!is.eof()) || (!is) || gridDecayShift < 1 || gridDecayShift > 31)
+        	{
+        		std::cout << "ERROR: Unable to parse --decay setting \"" << optarg << "\"\n";
+        		return 1;
+        	}
+        	break;
+        }
+
+        case OPT_TRIGGER:
+        	// --trigger "channel rising|falling level" (resolved when all -y are known)
+        	triggerSetting = optarg;
+        	break;
+
+        case OPT_TRIGGER_SAMPLES:
+        {
+        	std::istringstream is(optarg);
+        	is >> triggerSamples;
+        	if ((!is.eof()) || (!is) || triggerSamples < 2)
+        	{
+        		std::cout << "ERROR: Unable to parse --trigger-samples setting \"" << optarg << "\"\n";
+        		return 1;
+        	}
+        	break;
+        }
+
+        case OPT_PRETRIGGER:
+        {
+        	std::istringstream is(optarg);
+        	is >> preTriggerPercent;
+        	if ((!is.eof()) || (!is) || preTriggerPercent < 0 || preTriggerPercent > 99)
+        	{
+        		std::cout << "ERROR: Unable to parse --pretrigger setting \"" << optarg << "\"\n";
+        		return 1;
+        	}
+        	break;
+        }
+
+        case OPT_OVERLOAD:
+        {
+        	// --overload block|drop-oldest|drop-newest|decimate
+        	if (strcmp("block", optarg) == 0)
+        	{
+        		overloadPolicy = OVERLOAD_BLOCK;
+        	}
+        	else if (strcmp("drop-oldest", optarg) == 0)
+        	{
+        		overloadPolicy = OVERLOAD_DROP_OLDEST;
+        	}
+        	else if (strcmp("drop-newest", optarg) == 0)
+        	{
+        		overloadPolicy = OVERLOAD_DROP_NEWEST;
+        	}
+        	else if (strcmp("decimate", optarg) == 0)
+        	{
+        		overloadPolicy = OVERLOAD_DECIMATE;
+        	}
+        	else
+        	{
+        		std::cout << "ERROR: Unknown --overload policy \"" << optarg << "\"\n";
+        		return 1;
+        	}
+        	break;
+        }
+
+        case OPT_RECORD:
+        	recordFileName = optarg;
+        	break;
+
+        case OPT_REPLAY:
+        	replayFileName = optarg;
+        	break;
+
+        case OPT_SPEED:
+        {
+        	std::istringstream is(optarg);
+        	is >> replaySpeed;
+        	if ((!is.eof()) || (!is) || replaySpeed < 0)
+        	{
+        		std::cout << "ERROR: Unable to parse --speed setting \"" << optarg << "\"\n";
+        		return 1;
+        	}
+        	break;
+        }
+
+        case OPT_EXPORT_PREFIX:
+        	exportPrefix = optarg;
+        	break;
+
+        case OPT_EXPORT_FORMAT:
+        	// --export-format csv|binary
+        	if (strcmp("csv", optarg) == 0)
+        	{
+        		exportFormat = WaveformExporter::CSV;
+        	}
+        	else if (strcmp("binary", optarg) == 0)
+        	{
+        		exportFormat = WaveformExporter::BINARY;
+        	}
+        	else
+        	{
+        		std::cout << "ERROR: Unknown --export-format \"" << optarg << "\"\n";
+        		return 1;
+        	}
+        	break;
+
+        case OPT_COLUMNS:
+        	columns = ColumnParser::parseColumnList(optarg);
+        	if (columns.empty())
+        	{
+        		std::cout << "ERROR: Unable to parse --columns setting \"" << optarg << "\"\n";
+        		return 1;
+        	}
+        	break;
+
+        case OPT_DELIMITER:
+        	// --delimiter C (a single character, or "tab")
+        	if (strcmp("tab", optarg) == 0)
+        	{
+        		delimiter = '\t';
+        	}
+        	else if (strlen(optarg) == 1)
+        	{
+        		delimiter = optarg[0];
+        	}
+        	else
+        	{
+        		std::cout << "ERROR: Unable to parse --delimiter setting \"" << optarg << "\"\n";
+        		return 1;
+        	}
+        	break;
+
+        case OPT_INGEST_THREADS:
+        {
+        	std::istringstream is(optarg);
+        	is >> ingestThreads;
+        	if ((!is.eof()) || (!is) || ingestThreads < 1)
+        	{
+        		std::cout << "ERROR: Unable to parse --ingest-threads setting \"" << optarg << "\"\n";
+        		return 1;
+        	}
+        	break;
+        }
+
+        case OPT_MEMORY_LIMIT:
+        {
+        	size_t limit = 0;
+        	if (!MemoryBudget::parseSize(optarg, limit) || limit == 0)
+        	{
+        		std::cout << "ERROR: Unable to parse --memory-limit setting \"" << optarg << "\"\n";
+        		return 1;
+        	}
+        	g_memory_budget = MemoryBudget(limit);
+        	break;
+        }
+
+        case OPT_FFT_SIZE:
+        {
+        	std::istringstream is(optarg);
+        	is >> fftSize;
+        	if ((!is.eof()) || (!is) || fftSize > (1 << 24) || !FFT::isPowerOfTwo(fftSize))
+        	{
+        		std::cout << "ERROR: Unable to parse --fft-size setting \"" << optarg << "\" (must be a power of two)\n";
+        		return 1;
+        	}
+        	break;
+        }
+
+        case OPT_WINDOW:
+        {
+        	if (!SpectrumAnalyzer::parseWindow(optarg, spectrumWindow))
+        	{
+        		std::cout << "ERROR: Unable to parse --window setting \"" << optarg << "\"\n";
         		return 1;
         	}
         	break;
         }
 
-        case 'm':
+        case OPT_MAX_CHANNELS:
         {
-        	// --mode squeze|roll_ny
-        	if (strcmp("squeze", optarg) == 0)
-        	{
-        		displayMode = DisplayMode::SQUEZE;
-        	}
-        	else if (strcmp("roll_ny", optarg) == 0)
+        	std::istringstream is(optarg);
+        	is >> maxChannels;
+        	if ((!is.eof()) || (!is) || maxChannels < 1 || maxChannels > 4096)
         	{
-        		displayMode = DisplayMode::ROLL_NY;
+        		std::cout << "ERROR: Unable to parse --max-channels setting \"" << optarg << "\"\n";
+        		return 1;
         	}
         	break;
         }
 
-        case 'n':
+        case OPT_AVERAGE:
         {
         	std::istringstream is(optarg);
-        	is >> numSamples;
-        	if ((!is.eof()) || (!is))
+        	is >> spectrumAverages;
+        	if ((!is.eof()) || (!is) || spectrumAverages < 1)
         	{
-        		std::cout << "ERROR: Unable to parse -n setting \"" << optarg << "\"\n";
+        		std::cout << "ERROR: Unable to parse --average setting \"" << optarg << "\"\n";
         		return 1;
         	}
         	break;
@@ -452,7 +1650,7 @@ int main (int argc, char *argv[])
 
         case 'f':
           printf ("option -f with value `%s'\n", optarg);
-          inputFileName = optarg;
+          inputFileNames.push_back(optarg);
           break;
           
         case 'x':
@@ -463,11 +1661,11 @@ int main (int argc, char *argv[])
         case 'y':
           printf ("option -y with value `%s'\n", optarg);
           {
-			  int size = yPrefixes.size();
-			  yPrefixes[optarg] = size;
+			  // The trigger refers to the first channel with a prefix
+			  yPrefixes.insert(std::make_pair(std::string(optarg), g_waveforms.size()));
+			  numInputsBeforeChannel.push_back(inputFileNames.size());
 			  Waveform w;
 			  w.prefix = optarg;
-			  w.peakWaveform = 0;
 			  g_waveforms.push_back(w);
           }
           break;
@@ -488,67 +1686,781 @@ int main (int argc, char *argv[])
 		"-v, --verbose \n"
 		"-b, --brief\n"
 		"-h, --help\n"
-		"-f, --file file_with_reading\n"
+		"-f, --file INPUT  Read from INPUT: a file, FIFO, - for stdin (default), unix:PATH for a\n"
+		"    Unix domain stream socket, udp:[HOST:]PORT to receive datagrams (each one holding\n"
+		"    whole lines or frames) or tcp:[HOST:]PORT to accept connections. Several inputs are\n"
+		"    read at the same time. With more than one, each -y belongs to the -f before it\n"
+		"    (those before the first to the first)\n"
+		"--ingest-threads N  Read the inputs on up to N threads (input i on thread i modulo N).\n"
+		"    Every channel has a lock of its own, so channels of different inputs are stored in\n"
+		"    parallel. Defaults to 1\n"
 		"-y prefix_of_number_to_plot\n"
-		"-a, --axis \"xmin xmax ymin ymax\" Override plot axis (only caring about Y at the moment)\n"
-		"-m, --mode squeze|roll_ny   Sets display mode (squeze is default)\n"
+		"--auto  Find the channels in the input instead: a channel is added for every key of\n"
+		"    key=value fields (separated by spaces, tabs, commas or semicolons) when first seen.\n"
+		"    A -y KEY= gives the channel of KEY its place. With several inputs, channels are\n"
+		"    named INPUT:KEY=\n"
+		"--max-channels N  Room for channels with --auto (and planned for by --memory-limit).\n"
+		"    Defaults to %zu\n"
+		"-a, --axis \"xmin xmax ymin ymax\" Override plot axis (only caring about Y, except in xy mode)\n"
+		"-m, --mode squeze|roll_ny|persist|history|spectrum|xy   Sets display mode (squeze is default)\n"
 		"    squeze fits all data into the current window\n"
 		"    roll_ny rolls the data so only the last n samples are visible (specify n with -n )\n"
+		"    persist sweeps n samples at a time over a fading intensity graded display\n"
+		"    history keeps every sample losslessly compressed (within --memory-limit, dropping\n"
+		"    the oldest first), draws it as squeze, and exports every sample kept\n"
+		"    spectrum shows the magnitude spectrum (in dB) of the last --fft-size samples\n"
+		"    xy pairs up the channels (x, y), (x, y), ... and shows how often points land\n"
+		"    where, on a --grid fading 1/2^--decay every n points. A y is paired with the\n"
+		"    last x of its pair\n"
+		"--fft-size N  Samples per spectrum, a power of two. Defaults to %d\n"
+		"--window rect|hann|hamming|blackman  Window function of the spectrum. Defaults to hann\n"
+		"--average K  Spectrum mode averages the power of about the last K windows. Defaults to %d\n"
+		"--lttb  Draw each waveform as a line of about two points per pixel column, picked by\n"
+		"    Largest-Triangle-Three-Buckets, instead of one min/max bar and line per sample\n"
+		"--grid WxH  Resolution of the persist and xy mode intensity grids (scaled to the plot\n"
+		"    area when drawn, whatever the window size). Defaults to %dx%d\n"
+		"--decay SHIFT  Persist and xy mode fade 1/2^SHIFT of the hits each sweep. Defaults to %d\n"
 		"-n NUMBER Number of samples to span the full screen (in modes supporting that). Defaults to %d\n"
+		"--memory-limit SIZE  Memory for the storages of all channels together, like 512M or 2G.\n"
+		"    Sets -n to as many samples as fit (or caps it), and shrinks the storages if the\n"
+		"    limit is exceeded while running. The persist and xy mode grids have a fixed size\n"
+		"--columns LIST  Input lines are rows of columns, such as CSV. Each column in LIST (counting\n"
+		"    from 1, like 2,3,5 or 2-4) goes to a channel, named by the -y options in order (the\n"
+		"    -y prefixes are not looked for). Columns without a -y are named colN\n"
+		"--delimiter C  Column delimiter with --columns: a character, or tab. Defaults to runs of\n"
+		"    spaces and tabs\n"
+		"--binary  Input is binary frames (see BinaryFrame.hpp), value i going to the i:th -y channel\n"
+		"--harness  Count accepted, dropped and blocked samples, input pipe backlog and frame\n"
+		"    render times, and print a summary on exit (see tools/loadgen.cpp)\n"
+		"--stats  Print ingest rates, parse, lock wait, frame and snapshot times and memory use\n"
+		"    to stderr every second\n"
+		"--overlay  Show the same statistics over the plot (toggled with S)\n"
+		"--channel-stats  Keep count, mean, standard deviation, min, max and estimated 1st, 50th\n"
+		"    and 99th percentiles of every channel since the start. Shown over the plot (toggled\n"
+		"    with C), with --stats and on exit\n"
+		"--latency  Timestamp samples as they are read, and keep a histogram of the time until the\n"
+		"    first frame showing them is flipped. Printed on exit and when pressing L\n"
+		"--overload block|drop-oldest|drop-newest|decimate  What to do with samples arriving while\n"
+		"    the display copies the waveforms. block waits (default, may stall the writer). The\n"
+		"    others never wait, but hold up to %zu samples per channel, and when those are full\n"
+		"    drop the oldest, drop the newest, or reduce the held ones to min/max pairs\n"
+		"--record FILE  Write every sample read to a binary capture file (see CaptureFile.hpp)\n"
+		"--replay FILE  Read samples from a capture file instead of -f inputs. The recorded\n"
+		"    channels are shown, or only those named by -y\n"
+		"--speed N  Replay at N times the recorded speed, or as fast as possible with 0. Defaults to 1\n"
+		"--export-prefix PREFIX  Pressing E, or sending SIGUSR1, writes what the storages hold to\n"
+		"    PREFIX<date>-<time>-<number>.csv (or .bin) in the background. Defaults to export-\n"
+		"--export-format csv|binary  Format of those files (see WaveformExporter.hpp). Defaults to csv\n"
+		"--headless  Render into an offscreen framebuffer instead of a window (no display needed).\n"
+		"    SIGINT or SIGTERM ends the run as if the inputs had ended (printing any summary)\n"
+		"--dump-frames PREFIX  Write rendered frames as PREFIX<frame number>.ppm (headless only)\n"
+		"--dump-interval N  Only write every N:th frame (defaults to 1)\n"
+		"--frame-delay MS  Delay between rendered frames in milliseconds. Defaults to %d\n"
+		"--trigger \"CHANNEL rising|falling LEVEL\"  Only show windows of samples around trigger events.\n"
+		"    CHANNEL is a -y prefix, or the index of one (counting from 0)\n"
+		"--trigger-samples N  Number of samples per channel shown around each trigger event. Defaults to %d\n"
+		"--pretrigger PERCENT  Part of the trigger window that is before the trigger event. Defaults to %d\n"
 		"\n"
 		"Note that the -y argument require a prefix (including everything from the start of the line,\n"
 		"even all white spaces before the number, and that the number should be followed by a newline.\n"
-		"\n", argv[0], numSamples
+		"\n", argv[0], maxChannels, fftSize, spectrumAverages, gridColumns, gridRows, gridDecayShift, numSamples, overloadBufferSize,
+		frameDelayMs, triggerSamples, preTriggerPercent
 		);
 		return 1;
 	}
 
+    // Those have their channels fixed from the start
+    if (auto_flag && (binary_flag || !columns.empty() || !replayFileName.empty() || !recordFileName.empty()))
+    {
+    	std::cout << "ERROR: --auto can not be combined with --binary, --columns, --replay or --record\n";
+    	return 1;
+    }
+
+    // A replay brings its own channels, unless some are picked with -y
+    CaptureReader replay;
+    std::vector<size_t> replayChannels; // Waveform of each recorded channel (g_waveforms.size() if none)
+    if (!replayFileName.empty())
+    {
+    	if (!replay.open(replayFileName))
+    	{
+    		std::cout << "ERROR: Unable to read capture file \"" << replayFileName << "\"\n";
+    		return 1;
+    	}
+    	if (!inputFileNames.empty())
+    	{
+    		std::cout << "WARNING: -f is ignored when replaying\n";
+    	}
+
+    	if (g_waveforms.empty())
+    	{
+    		for (const auto& name : replay.getChannelNames())
+    		{
+    			yPrefixes.insert(std::make_pair(name, g_waveforms.size()));
+    			numInputsBeforeChannel.push_back(0);
+    			Waveform w;
+    			w.prefix = name;
+    			g_waveforms.push_back(w);
+    		}
+    	}
+    	for (const auto& name : replay.getChannelNames())
+    	{
+    		replayChannels.push_back(yPrefixes.count(name) ? yPrefixes[name] : g_waveforms.size());
+    	}
+    }
+
+    // Columns beyond those named by -y get channels of the last input
+    if (!columns.empty() && replayFileName.empty())
+    {
+    	for (size_t i = g_waveforms.size(); i < columns.size(); i++)
+    	{
+    		Waveform w;
+    		w.prefix = "col" + std::to_string(columns[i] + 1);
+    		yPrefixes.insert(std::make_pair(w.prefix, g_waveforms.size()));
+    		numInputsBeforeChannel.push_back(inputFileNames.size());
+    		g_waveforms.push_back(w);
+    	}
+    }
+
+    if (displayMode == DisplayMode::SPECTRUM)
+    {
+    	// The storages keep the window analyzed
+    	numSamples = fftSize;
+    }
+
+    if (displayMode == DisplayMode::PLOT_XY)
+    {
+    	if (!auto_flag && (g_waveforms.empty() || g_waveforms.size() % 2))
+    	{
+    		std::cout << "ERROR: -m xy needs channels in (x, y) pairs\n";
+    		return 1;
+    	}
+    	if ((gridColumns & 1) && !(axis.isValidX() && axis.isValidY()))
+    	{
+    		std::cout << "ERROR: -m xy needs an even --grid width, unless --axis gives the range\n";
+    		return 1;
+    	}
+    }
+
+    // With --auto, planned for as many channels as there is room for
+    const size_t numPlannedChannels = auto_flag ? std::max(maxChannels, g_waveforms.size()) : g_waveforms.size();
+    if (g_memory_budget.isLimited())
+    {
+    	// Besides its storage, each channel has an overload buffer, trigger
+    	// rings and a chunk of a capture file
+    	g_fixed_bytes_per_channel = 2 * overloadBufferSize * sizeof(double);
+    	if (!triggerSetting.empty())
+    	{
+    		g_fixed_bytes_per_channel += 3 * size_t(triggerSamples) * sizeof(double);
+    	}
+    	if (!recordFileName.empty())
+    	{
+    		g_fixed_bytes_per_channel += 4096 * sizeof(double);
+    	}
+
+    	if (displayMode == DisplayMode::PLOT_XY)
+    	{
+    		// The xy grid and the copy of it drawn, shared by all channels
+    		g_fixed_bytes_per_channel += (2 * size_t(gridColumns) * gridRows * sizeof(uint32_t) +
+    				numPlannedChannels - 1) / numPlannedChannels;
+    	}
+
+    	if (displayMode == DisplayMode::PERSIST)
+    	{
+    		// The copy of the grid drawn (the storage accounts for its own)
+    		const size_t gridBytes = size_t(gridColumns) * gridRows * sizeof(uint32_t);
+    		g_fixed_bytes_per_channel += gridBytes;
+    		if (numPlannedChannels * (g_fixed_bytes_per_channel + gridBytes +
+    				3 * size_t(gridColumns) * sizeof(MinMax<double>)) > g_memory_budget.getLimit())
+    		{
+    			std::cout << "ERROR: --memory-limit is too small for " << numPlannedChannels << " channels of that --grid\n";
+    			return 1;
+    		}
+    	}
+    	else if (displayMode == DisplayMode::SPECTRUM)
+    	{
+    		// The window of samples (up to twice, plus the copy drawn), the
+    		// analyzer (buffer, twiddles, window and power) and the spectra
+    		// published and drawn
+    		g_fixed_bytes_per_channel += size_t(fftSize) * (2 * sizeof(std::complex<double>) + 2 * sizeof(double)) +
+    				2 * size_t(fftSize / 2 + 1) * sizeof(MinMax<double>);
+    		if (numPlannedChannels * (g_fixed_bytes_per_channel + 3 * size_t(fftSize) * sizeof(MinMax<double>)) >
+    				g_memory_budget.getLimit())
+    		{
+    			std::cout << "ERROR: --memory-limit is too small for " << numPlannedChannels << " channels of that --fft-size\n";
+    			return 1;
+    		}
+    	}
+    	else
+    	{
+    		// A point is kept by the storage (up to twice in the FIFO of roll
+    		// and xy mode, and once more at half resolution in squeze mode),
+    		// the copy drawn and an export
+    		size_t bytesPerPoint = sizeof(MinMax<double>) * (displayMode == DisplayMode::HISTORY ? 3 : 4);
+    		size_t points = g_memory_budget.pointsPerChannel(numPlannedChannels, bytesPerPoint, g_fixed_bytes_per_channel);
+    		points = std::min<size_t>(points, std::numeric_limits<int>::max() - 1);
+    		if (points == 0)
+    		{
+    			std::cout << "ERROR: --memory-limit is too small for " << numPlannedChannels << " channels\n";
+    			return 1;
+    		}
+    		if (displayMode == DisplayMode::HISTORY)
+    		{
+    			// At most half of it for the points, the rest for the history
+    			points = std::max<size_t>(2, points / 2 & ~size_t(1));
+    			if (size_t(numSamples) > points)
+    			{
+    				numSamples = int(points);
+    			}
+    			g_history_bytes_per_channel = g_memory_budget.getLimit() / numPlannedChannels -
+    					g_fixed_bytes_per_channel - size_t(numSamples) * bytesPerPoint;
+    			fprintf(stderr, "Memory limit: keeping %d points and %.1f MB of history per channel\n",
+    					numSamples, g_history_bytes_per_channel / 1e6);
+    		}
+    		else
+    		{
+    			if (!numSamplesSet || size_t(numSamples) > points)
+    			{
+    				numSamples = int(points);
+    			}
+    			fprintf(stderr, "Memory limit: keeping %d points per channel\n", numSamples);
+    		}
+    	}
+    }
+
+    switch(displayMode)
+    {
+    case DisplayMode::SQUEZE:   g_storage_kind = StorageKind::CAPPED_PEAK; break;
+    case DisplayMode::ROLL_NY:  g_storage_kind = StorageKind::FIFO; break;
+    case DisplayMode::PERSIST:  g_storage_kind = StorageKind::PERSISTENCE; break;
+    case DisplayMode::HISTORY:  g_storage_kind = StorageKind::COMPRESSED; break;
+    case DisplayMode::SPECTRUM: g_storage_kind = StorageKind::FIFO; break;
+    case DisplayMode::PLOT_XY:  g_storage_kind = StorageKind::FIFO; break;
+    }
     for (auto & waveform : g_waveforms)
     {
-    	switch(displayMode)
+    	waveform.peakWaveform.reset(newStorage());
+    }
+
+    // Room for the channels --auto adds
+    g_num_channels = g_waveforms.size();
+    if (auto_flag)
+    {
+    	g_waveforms.resize(numPlannedChannels);
+    }
+
+    if (displayMode == DisplayMode::PLOT_XY)
+    {
+    	g_xy_density.reset(new XYDensityGrid(gridColumns, gridRows, numSamples, gridDecayShift));
+    	if (axis.isValidX() && axis.isValidY())
+    	{
+    		g_xy_density->setRange(axis.minx, axis.maxx, axis.miny, axis.maxy);
+    	}
+    	g_xy_last_x.assign(g_waveforms.size() / 2 + 1, std::numeric_limits<double>::quiet_NaN());
+    }
+
+    if (!triggerSetting.empty())
+    {
+    	std::istringstream is(triggerSetting);
+    	std::string channelName;
+    	std::string edgeName;
+    	double level = 0;
+    	is >> channelName >> edgeName >> level;
+    	if ((!is.eof()) || (!is) || (edgeName != "rising" && edgeName != "falling"))
+    	{
+    		std::cout << "ERROR: Unable to parse --trigger setting \"" << triggerSetting << "\"\n";
+    		return 1;
+    	}
+
+    	size_t channel = numChannels();
+    	if (yPrefixes.count(channelName))
+    	{
+    		channel = yPrefixes[channelName];
+    	}
+    	else
     	{
-    	case DisplayMode::SQUEZE:
-    		waveform.peakWaveform = new CappedPeakStorageWaveform<double>(numSamples);
-    		break;
-    	case DisplayMode::ROLL_NY:
-    		waveform.peakWaveform = new FIFOStorageWaveform<double>(numSamples);
-    		break;
+    		std::istringstream channelIs(channelName);
+    		channelIs >> channel;
+    		if (!channelIs.eof() || !channelIs)
+    		{
+    			channel = numChannels();
+    		}
     	}
+    	if (channel >= numChannels())
+    	{
+    		std::cout << "ERROR: Unknown trigger channel \"" << channelName << "\"\n";
+    		return 1;
+    	}
+
+    	size_t preTrigger = size_t(triggerSamples) * preTriggerPercent / 100;
+    	g_trigger.reset(new TriggerCapture<double>(
+    			g_waveforms.size(), channel, level,
+    			edgeName == "rising" ? TriggerCapture<double>::RISING : TriggerCapture<double>::FALLING,
+    			preTrigger, triggerSamples - preTrigger));
     }
 
-	std::thread thread1(sdlDisplayThread);
+	if (!frameDumpPrefix.empty() && !headless_flag)
+	{
+		std::cout << "WARNING: --dump-frames is only supported together with --headless\n";
+	}
 
-	std::string line;
-	double y = 0;
-	std::ifstream in(inputFileName.c_str());
-	while (!quit && getline(in, line))
+	if (harness_flag)
 	{
-		usleep(1);
+		g_harness.reset(new Harness());
+	}
+
+	g_channel_locks.reset(new ChannelLock[g_waveforms.size()]);
+
+	PerfCounters::setNumChannels(g_waveforms.size());
+	PerfCounters::setEnabled(stats_flag || overlay_flag);
 
-		if (xPrefix.size() && line.find(xPrefix) != line.npos)
+	// Each input has its own channels
+	struct Input {
+		PrefixMatcher matcher;
+		ColumnParser columns;
+		KeyValueParser keys; // With --auto
+		std::vector<size_t> channels;
+	};
+
+	// Each stream of an input (one per connection for TCP) keeps what was
+	// left of a line (or binary frame) at the end of the last read
+	struct InputStream {
+		LineSplitter lines;
+		BinaryFrameSplitter frames;
+	};
+
+	if (inputFileNames.empty())
+	{
+		inputFileNames.push_back("/dev/stdin");
+	}
+	std::vector<Input> inputs(inputFileNames.size());
+	for (size_t channel = 0; channel < numChannels(); channel++)
+	{
+		size_t input = std::max<size_t>(numInputsBeforeChannel[channel], 1) - 1;
+		if (inputs.size() == 1)
 		{
-			// found an x-prefix.
-//			x = std::atof(line.substr(xPrefix.size()).c_str());
-			//printf("X_PREFIXED LINE: \"%s\" (%f)\n", line.c_str(), x);
-//			newX = true;
-			continue;
+			input = 0;
 		}
-		
-		for (auto& tmp : yPrefixes)
+		inputs[input].matcher.addPrefix(g_waveforms[channel].prefix, channel);
+		inputs[input].channels.push_back(channel);
+
+		// A -y "key=" with --auto names the channel of key
+		const std::string& prefix = g_waveforms[channel].prefix;
+		if (auto_flag && prefix.size() > 1 && prefix.back() == '=')
+		{
+			inputs[input].keys.addKey(prefix.substr(0, prefix.size() - 1), channel);
+		}
+	}
+	for (auto& input : inputs)
+	{
+		// The i:th column goes to the i:th channel of the input
+		input.columns = ColumnParser(delimiter);
+		for (size_t i = 0; i < columns.size() && i < input.channels.size(); i++)
+		{
+			input.columns.addColumn(columns[i], input.channels[i]);
+		}
+	}
+
+	CaptureWriter recorder;
+	if (!recordFileName.empty())
+	{
+		std::vector<std::string> channelNames;
+		for (const auto& waveform : g_waveforms)
+		{
+			channelNames.push_back(waveform.prefix);
+		}
+		if (!recorder.open(recordFileName, channelNames))
+		{
+			std::cout << "ERROR: Unable to create capture file \"" << recordFileName << "\"\n";
+			return 1;
+		}
+	}
+	const std::chrono::steady_clock::time_point recordStart = std::chrono::steady_clock::now();
+	std::mutex recorderMutex; // Shared by the ingest threads
+
+	struct sigaction exportAction;
+	memset(&exportAction, 0, sizeof(exportAction));
+	exportAction.sa_handler = requestExport;
+	exportAction.sa_flags = SA_RESTART;
+	sigaction(SIGUSR1, &exportAction, 0);
+
+	if (headless_flag)
+	{
+		struct sigaction quitAction;
+		memset(&quitAction, 0, sizeof(quitAction));
+		quitAction.sa_handler = requestQuit;
+		quitAction.sa_flags = SA_RESTART | SA_RESETHAND;
+		sigaction(SIGINT, &quitAction, 0);
+		sigaction(SIGTERM, &quitAction, 0);
+	}
+
+	std::thread thread1(headless_flag ? offscreenDisplayThread : sdlDisplayThread);
+
+	// Opened with the window up, as a FIFO waits for its writer. Input i is
+	// read by ingest thread i % numIngestThreads, which waits for all of its
+	// inputs with epoll.
+	const size_t numIngestThreads = std::min<size_t>(ingestThreads, inputFileNames.size());
+	std::vector<std::unique_ptr<InputMultiplexer> > multiplexers;
+	std::vector<std::vector<size_t> > inputOfSource(numIngestThreads); // Per ingest thread
+	for (size_t thread = 0; thread < numIngestThreads; thread++)
+	{
+		multiplexers.push_back(std::unique_ptr<InputMultiplexer>(new InputMultiplexer()));
+	}
+	for (size_t i = 0; i < inputFileNames.size(); i++)
+	{
+		if (!replayFileName.empty())
+		{
+			break;
+		}
+		const size_t thread = i % numIngestThreads;
+		if (multiplexers[thread]->addSource(inputFileNames[i]) < 0)
+		{
+			std::cout << "ERROR: Unable to open input \"" << inputFileNames[i] << "\": " << strerror(errno) << "\n";
+			quit = true;
+			thread1.join();
+			return 1;
+		}
+		inputOfSource[thread].push_back(i);
+	}
+
+	// Only used by the non blocking overload policies. Each one is only
+	// touched by the thread reading its channel.
+	std::vector<OverloadBuffer<double> > overloadBuffers;
+	if (overloadPolicy != OVERLOAD_BLOCK)
+	{
+		OverloadBuffer<double>::Policy policy =
+				overloadPolicy == OVERLOAD_DROP_OLDEST ? OverloadBuffer<double>::DROP_OLDEST :
+				overloadPolicy == OVERLOAD_DROP_NEWEST ? OverloadBuffer<double>::DROP_NEWEST :
+				OverloadBuffer<double>::DECIMATE;
+		overloadBuffers.resize(g_waveforms.size(), OverloadBuffer<double>(policy, overloadBufferSize));
+	}
+
+	// Lines are only timed while someone looks at the result
+	const auto & lineParsed = [](bool timed, PerfCounters::Clock::time_point parseStart) {
+		PerfCounters::add(PerfCounters::LINES);
+		if (timed)
 		{
-			const std::string& yPrefix = tmp.first;
-			if (line.find(yPrefix) != line.npos)
+			PerfCounters::addTime(PerfCounters::PARSE_NS, PerfCounters::Clock::now() - parseStart);
+			PerfCounters::add(PerfCounters::TIMED_LINES);
+		}
+	};
+
+	// Reads the inputs of multiplexer until they end (or quit is set), or
+	// replays the capture file when multiplexer is null. Runs once per
+	// ingest thread, with state of its own.
+	const auto & ingest = [&](InputMultiplexer* multiplexer, const std::vector<size_t>& inputOfSource) {
+		// When the line (or binary frame) being parsed was read, with --latency
+		std::chrono::steady_clock::time_point readTime;
+
+		// Time of the samples being recorded
+		int64_t recordTimeNs = 0;
+
+		// Expects the lock of the channel to be held
+		const auto & storeSample = [&](size_t channel, double y) {
+			Waveform& waveform = g_waveforms[channel];
+			pushToStorage(g_storage_kind, *waveform.peakWaveform, y);
+			if (channel_stats_flag)
 			{
-				y = std::atof(line.substr(yPrefix.size()).c_str());
-							
-				std::lock_guard<std::mutex> guard(g_waveforms_mutex);
-				g_waveforms[tmp.second].peakWaveform->push(y);
-				continue;
+				waveform.statistics.push(y);
+			}
+			if (displayMode == DisplayMode::PLOT_XY)
+			{
+				pushXY(channel, y);
+			}
+			if (latency_flag && waveform.unshownSince == std::chrono::steady_clock::time_point())
+			{
+				waveform.unshownSince = readTime;
+			}
+			if (g_trigger)
+			{
+				g_trigger->push(channel, y);
+			}
+			PerfCounters::addSamples(channel);
+			if (g_harness)
+			{
+				g_harness->samplesAccepted(1);
+			}
+		};
+
+		// Expects the lock of the channel to be held
+		const auto & storeHeldSamples = [&](size_t channel) {
+			const auto & store = [&](double y) { storeSample(channel, y); };
+			overloadBuffers[channel].flush(store);
+		};
+
+		const auto & pushSample = [&](size_t channel, double y) {
+			if (recorder.isOpen())
+			{
+				std::lock_guard<std::mutex> recorderGuard(recorderMutex);
+				recorder.write(channel, y, recordTimeNs);
+			}
+
+			std::unique_lock<std::mutex> guard(g_channel_locks[channel].mutex, std::try_to_lock);
+			if (!guard.owns_lock() && !overloadBuffers.empty())
+			{
+				size_t lost = overloadBuffers[channel].push(y);
+				PerfCounters::add(PerfCounters::DEFERRED);
+				if (lost)
+				{
+					PerfCounters::add(overloadPolicy == OVERLOAD_DECIMATE ?
+							PerfCounters::DECIMATED : PerfCounters::DROPPED, lost);
+					if (g_harness)
+					{
+						g_harness->samplesDropped(lost);
+					}
+				}
+				return;
+			}
+			if (!guard.owns_lock())
+			{
+				Harness::Clock::time_point waitStart = Harness::Clock::now();
+				guard.lock();
+				Harness::Clock::duration waited = Harness::Clock::now() - waitStart;
+				PerfCounters::add(PerfCounters::LOCK_WAITS);
+				PerfCounters::addTime(PerfCounters::LOCK_WAIT_NS, waited);
+				if (g_harness)
+				{
+					g_harness->sampleBlocked(waited);
+				}
+			}
+
+			if (!overloadBuffers.empty() && !overloadBuffers[channel].empty())
+			{
+				storeHeldSamples(channel);
+			}
+			storeSample(channel, y);
+		};
+
+		PerfCounters::Clock::time_point parseStart;
+
+		size_t numRead = 0;
+		Input* input = 0;
+
+		std::vector<InputStream> inputStreams;
+
+		const auto & countRead = [&](size_t bytes) {
+			if (g_harness)
+			{
+				g_harness->lineRead(bytes);
+				if ((++numRead & 1023) == 0)
+				{
+					g_harness->inputBacklog(multiplexer->getPendingBytes());
+				}
+			}
+		};
+
+		// Value i of a frame goes to the i:th channel of the input
+		const auto & handleFrame = [&](const double* values, size_t numValues, size_t frameBytes) {
+			const bool timed = PerfCounters::isEnabled();
+			if (timed)
+			{
+				parseStart = PerfCounters::Clock::now();
+			}
+			size_t numUsed = std::min(numValues, input->channels.size());
+			for (size_t i = 0; i < numUsed; i++)
+			{
+				pushSample(input->channels[i], values[i]);
+			}
+			lineParsed(timed, parseStart);
+
+			countRead(frameBytes);
+			if (g_harness)
+			{
+				g_harness->samplesDropped(numValues - numUsed);
+			}
+		};
+
+		// A key seen for the first time on input (with --auto). Named by the
+		// input too, when there are several.
+		const auto & newKey = [&](const std::string& key) {
+			std::string prefix = key + "=";
+			if (inputs.size() > 1)
+			{
+				prefix = inputFileNames[input - &inputs[0]] + ":" + prefix;
+			}
+			size_t channel = addChannel(prefix);
+			if (channel != KeyValueParser::NO_CHANNEL)
+			{
+				input->channels.push_back(channel);
+			}
+			return channel;
+		};
+
+		// A line, as found in place in the read buffer by LineSplitter
+		const auto & handleLine = [&](const char* line, size_t size) {
+			countRead(size + 1);
+
+			if (xPrefix.size() && memmem(line, size, xPrefix.data(), xPrefix.size()))
+			{
+				// found an x-prefix.
+//				x = std::atof(line.substr(xPrefix.size()).c_str());
+				//printf("X_PREFIXED LINE: \"%s\" (%f)\n", line.c_str(), x);
+//				newX = true;
+				return;
+			}
+
+			const bool timed = PerfCounters::isEnabled();
+			if (timed)
+			{
+				parseStart = PerfCounters::Clock::now();
+			}
+			if (auto_flag)
+			{
+				input->keys.parse(line, size, pushSample, newKey);
+			}
+			else if (input->columns.empty())
+			{
+				input->matcher.match(line, size, pushSample);
+			}
+			else
+			{
+				input->columns.parse(line, size, pushSample);
 			}
+			lineParsed(timed, parseStart);
+		};
+
+		// data is null at the end of a stream. A datagram is complete in itself.
+		const auto & handleRead = [&](size_t source, size_t stream, char* data, size_t size) {
+			input = &inputs[inputOfSource[source]];
+			if (stream >= inputStreams.size())
+			{
+				inputStreams.resize(stream + 1);
+			}
+			InputStream& inputStream = inputStreams[stream];
+			const bool finished = !data || multiplexer->isDatagram(source);
+
+			if (latency_flag)
+			{
+				readTime = std::chrono::steady_clock::now();
+			}
+			if (recorder.isOpen())
+			{
+				recordTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+						std::chrono::steady_clock::now() - recordStart).count();
+			}
+
+			if (binary_flag)
+			{
+				if (data && !inputStream.frames.push(data, size, handleFrame))
+				{
+					std::cout << "ERROR: Lost sync with binary input frames from \""
+							<< multiplexer->getName(source) << "\"\n";
+				}
+				if (finished)
+				{
+					inputStream.frames.finish();
+				}
+				return;
+			}
+
+			if (data)
+			{
+				inputStream.lines.push(data, size, handleLine);
+
+				// Gives the renderer a chance at the locks. Not needed (nor
+				// wanted) when the policy is to never keep the writer waiting.
+				if (overloadPolicy == OVERLOAD_BLOCK)
+				{
+					usleep(1);
+				}
+			}
+			if (finished)
+			{
+				inputStream.lines.finish(handleLine);
+			}
+		};
+
+		// Paced by the recorded times (unless replaySpeed is 0)
+		const std::chrono::steady_clock::time_point replayStart = std::chrono::steady_clock::now();
+		const auto & replaySample = [&](size_t recordedChannel, double y, int64_t timeNs) {
+			if (replaySpeed > 0)
+			{
+				std::chrono::steady_clock::time_point due =
+						replayStart + std::chrono::nanoseconds(int64_t(timeNs / replaySpeed));
+				if (due - std::chrono::steady_clock::now() > std::chrono::milliseconds(1))
+				{
+					std::this_thread::sleep_until(due);
+				}
+			}
+			if (latency_flag)
+			{
+				readTime = std::chrono::steady_clock::now();
+			}
+			recordTimeNs = timeNs;
+
+			if (replayChannels[recordedChannel] < g_waveforms.size())
+			{
+				pushSample(replayChannels[recordedChannel], y);
+			}
+			return !quit;
+		};
+
+		if (!multiplexer)
+		{
+			replay.replay(replaySample);
+		}
+
+		while (multiplexer && !quit && multiplexer->read(handleRead, 100))
+		{
+		}
+
+		// Stores what is still held back, of the channels this thread reads
+		std::vector<size_t> channels;
+		for (size_t input : inputOfSource)
+		{
+			channels.insert(channels.end(), inputs[input].channels.begin(), inputs[input].channels.end());
+		}
+		for (size_t channel = 0; channel < g_waveforms.size() && !multiplexer; channel++)
+		{
+			channels.push_back(channel);
+		}
+		for (size_t channel : channels)
+		{
+			if (!overloadBuffers.empty() && !overloadBuffers[channel].empty())
+			{
+				std::lock_guard<std::mutex> guard(g_channel_locks[channel].mutex);
+				storeHeldSamples(channel);
+			}
+		}
+	};
+
+	if (!replayFileName.empty())
+	{
+		ingest(0, std::vector<size_t>());
+	}
+	else
+	{
+		std::vector<std::thread> readers;
+		for (size_t thread = 1; thread < numIngestThreads; thread++)
+		{
+			readers.push_back(std::thread(ingest, multiplexers[thread].get(), inputOfSource[thread]));
+		}
+		ingest(multiplexers[0].get(), inputOfSource[0]);
+		for (auto& reader : readers)
+		{
+			reader.join();
 		}
 	}
 
+	if (overloadPolicy != OVERLOAD_BLOCK)
+	{
+		PerfCounters::Snapshot counters = PerfCounters::read();
+		fprintf(stderr, "Overload: %llu samples held back while drawing, %llu dropped, %llu decimated\n",
+				(unsigned long long)counters.get(PerfCounters::DEFERRED),
+				(unsigned long long)counters.get(PerfCounters::DROPPED),
+				(unsigned long long)counters.get(PerfCounters::DECIMATED));
+	}
+
+	if (recorder.isOpen() && !recorder.close())
+	{
+		std::cout << "ERROR: Failed writing capture file \"" << recordFileName << "\"\n";
+	}
+
 	quit = true;
 	thread1.join();
+
+	if (g_harness)
+	{
+		g_harness->printSummary(stderr);
+	}
 	return 0;
 }
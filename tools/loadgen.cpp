@@ -0,0 +1,170 @@
+/*
+ * loadgen.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+/*
+ * Load generator for finding the maximum sustained input rate of the plotter.
+ * Writes prefix=value lines (like test_input.txt) or binary frames to stdout,
+ * e.g.
+ *
+ *   ./loadgen -c 4 -r 200000 -n 1000000 | ./RollmodeDataPlotter --headless --harness -y y0= -y y1= -y y2= -y y3=
+ *
+ * A summary, including how long writes were blocked by a full pipe,
+ * is printed to stderr on exit.
+ */
+
+#include "../BinaryFrame.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <errno.h>
+#include <getopt.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+static std::chrono::steady_clock::duration blockedTime(0);
+
+/**
+ * Writes everything, keeping track of the time spent in write()
+ * @return false if the reader went away
+ */
+static bool writeAll(const char* data, size_t size)
+{
+	while (size)
+	{
+		std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+		ssize_t written = write(1, data, size);
+		blockedTime += std::chrono::steady_clock::now() - t0;
+
+		if (written < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return false;
+		}
+		data += written;
+		size -= written;
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	double rate = 0; // samples/s over all channels, 0 = as fast as possible
+	int numChannels = 1;
+	long long numFrames = 0; // per channel, 0 = until killed
+	bool binary = false;
+	std::string prefix = "y";
+
+	int c;
+	while ((c = getopt(argc, argv, "r:c:n:p:bh")) != -1)
+	{
+		switch (c)
+		{
+		case 'r': rate = atof(optarg); break;
+		case 'c': numChannels = atoi(optarg); break;
+		case 'n': numFrames = atoll(optarg); break;
+		case 'p': prefix = optarg; break;
+		case 'b': binary = true; break;
+		default:
+			fprintf(stderr,
+					"%s [options]\n"
+					"-r RATE    Samples per second (over all channels). 0 = as fast as possible (default)\n"
+					"-c N       Number of channels. Defaults to 1\n"
+					"-n N       Number of samples per channel. 0 = until killed (default)\n"
+					"-p PREFIX  Lines are PREFIX<channel>=<value>. Defaults to y\n"
+					"-b         Write binary frames (see BinaryFrame.hpp) instead of text lines\n",
+					argv[0]);
+			return 1;
+		}
+	}
+	if (numChannels < 1 || numChannels > BINARY_FRAME_MAX_VALUES)
+	{
+		fprintf(stderr, "ERROR: Invalid number of channels %d\n", numChannels);
+		return 1;
+	}
+
+	// Let a closed pipe end the program through the write() error instead
+	signal(SIGPIPE, SIG_IGN);
+
+	std::vector<char> buffer;
+	buffer.reserve(1 << 20);
+
+	const double framesPerSecond = rate / numChannels;
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	long long frame = 0;
+	bool ok = true;
+
+	while (ok && (numFrames == 0 || frame < numFrames))
+	{
+		// Generate what should have been sent by now (fixed size batches when unthrottled)
+		long long target = frame + 4096;
+		if (framesPerSecond > 0)
+		{
+			double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			target = (long long)(elapsed * framesPerSecond) + 1;
+			if (target <= frame)
+			{
+				usleep(std::min(1000.0, 1e6 * (frame - target + 1) / framesPerSecond));
+				continue;
+			}
+		}
+		if (target > frame + 65536)
+		{
+			target = frame + 65536;
+		}
+		if (numFrames && target > numFrames)
+		{
+			target = numFrames;
+		}
+
+		buffer.clear();
+		for (; frame < target; frame++)
+		{
+			if (binary)
+			{
+				BinaryFrameHeader header = { BINARY_FRAME_MAGIC, uint32_t(numChannels) };
+				buffer.insert(buffer.end(), (const char*)&header, (const char*)&header + sizeof(header));
+			}
+			for (int channel = 0; channel < numChannels; channel++)
+			{
+				double value = sin(frame * 0.001 * (channel + 1)) + 0.1 * channel;
+				if (binary)
+				{
+					buffer.insert(buffer.end(), (const char*)&value, (const char*)&value + sizeof(value));
+				}
+				else
+				{
+					char line[64];
+					int len = snprintf(line, sizeof(line), "%s%d=%.6f\n", prefix.c_str(), channel, value);
+					buffer.insert(buffer.end(), line, line + len);
+				}
+			}
+		}
+		ok = writeAll(buffer.data(), buffer.size());
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	double blockedSeconds = std::chrono::duration<double>(blockedTime).count();
+	fprintf(stderr,
+			"loadgen: %lld samples (%d channels) in %.3f s = %.0f samples/s, %.3f s (%.1f%%) blocked in write%s\n",
+			frame * numChannels, numChannels, seconds, frame * numChannels / seconds,
+			blockedSeconds, 100 * blockedSeconds / seconds,
+			ok ? "" : ", reader went away");
+	return ok ? 0 : 1;
+}
@@ -12,6 +12,8 @@
 
 #include "../StreamProcessors/CappedPeakStorageWaveform.hpp"
 
+#include <memory>
+
 #define BRACED_INIT_LIST(...) {__VA_ARGS__}
 /**
  * Usage:
@@ -189,4 +191,99 @@ BOOST_AUTO_TEST_CASE(severalCompactions)
 //	CHECK_VECTORS((0, 8, 16, 24), w.getWaveform());
 }
 
+BOOST_AUTO_TEST_CASE(setCapacity)
+{
+	// Room for the points and as many half resolution points
+	CappedPeakStorageWaveform<int16_t> w(8);
+	BOOST_CHECK_EQUAL(2 * 8 * sizeof(MinMax<int16_t>), w.memoryUsage());
+
+	for (int16_t i = 0; i < 8; i++)
+	{
+		w.push(i);
+	}
+	BOOST_CHECK_EQUAL(8, w.getWaveform().size());
+
+	w.setCapacity(4); // Compacts once
+	BOOST_CHECK_EQUAL(4, w.getWaveform().size());
+	BOOST_CHECK_EQUAL(2 * 4 * sizeof(MinMax<int16_t>), w.memoryUsage());
+
+	w.push(8);
+	BOOST_CHECK_EQUAL(4, w.getWaveform().size());
+	w.push(9); // Compacts again, within the new capacity
+	BOOST_CHECK_EQUAL(3, w.getWaveform().size());
+}
+
+BOOST_AUTO_TEST_CASE(sameAsCompactingInOneGo)
+{
+	const size_t sizes[] = { 2, 4, 6, 64 };
+	for (size_t size : sizes)
+	{
+		CappedPeakStorageWaveform<int16_t> w(size);
+		std::vector<int16_t> samples;
+
+		// The samples [first, last) of each point, halved all at once
+		std::vector<std::pair<size_t, size_t> > ranges;
+		size_t skip = 0;
+		size_t counter = 0;
+		size_t first = 0;
+
+		for (size_t i = 0; i < 5000; i++)
+		{
+			samples.push_back(int16_t((i * 7919) % 2003 - 1000));
+			w.push(samples.back());
+
+			if (counter == skip)
+			{
+				if (ranges.size() == size)
+				{
+					for (size_t r = 0; r < size / 2; r++)
+					{
+						ranges[r] = std::make_pair(ranges[2 * r].first, ranges[2 * r + 1].second);
+					}
+					ranges.resize(size / 2);
+					skip = skip * 2 + 1;
+				}
+				ranges.push_back(std::make_pair(first, i + 1));
+				first = i + 1;
+				counter = 0;
+			}
+			else
+			{
+				counter++;
+			}
+
+			const std::vector<MinMax<int16_t> >& points = w.getWaveform();
+			BOOST_REQUIRE_EQUAL(points.size(), ranges.size());
+			for (size_t p = 0; p < points.size(); p++)
+			{
+				MinMax<int16_t> expected;
+				for (size_t s = ranges[p].first; s < ranges[p].second; s++)
+				{
+					expected.update(samples[s]);
+				}
+				BOOST_REQUIRE_EQUAL(points[p].min, expected.min);
+				BOOST_REQUIRE_EQUAL(points[p].max, expected.max);
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(duplicateCanBePushedTo)
+{
+	CappedPeakStorageWaveform<int16_t> w(4);
+	for (int16_t i = 0; i < 6; i++)
+	{
+		w.push(i);
+	}
+	std::unique_ptr<IWaveformStorage<int16_t> > copy(w.duplicate());
+	for (int16_t i = 6; i < 16; i++)
+	{
+		w.push(i);
+		copy->push(i);
+		BOOST_REQUIRE_EQUAL(copy->getWaveform().size(), w.getWaveform().size());
+		BOOST_CHECK_EQUAL(copy->getWaveform().back().max, w.getWaveform().back().max);
+		BOOST_CHECK_EQUAL(copy->getWaveform().front().min, w.getWaveform().front().min);
+	}
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,161 @@
+/*
+ * CaptureFile_Test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../CaptureFile.hpp"
+
+#include <string>
+#include <vector>
+
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+BOOST_AUTO_TEST_SUITE(CaptureFile_Test)
+
+
+struct Sample {
+	size_t channel;
+	double value;
+	int64_t timeNs;
+};
+
+struct TempFile {
+	std::string name;
+	TempFile()
+	{
+		char buffer[] = "/tmp/CaptureFile_TestXXXXXX";
+		int fd = mkstemp(buffer);
+		close(fd);
+		name = buffer;
+	}
+	~TempFile()
+	{
+		unlink(name.c_str());
+	}
+};
+
+static std::vector<Sample> replayAll(CaptureReader& reader)
+{
+	std::vector<Sample> samples;
+	const auto & collect = [&](size_t channel, double value, int64_t timeNs) {
+		Sample sample = { channel, value, timeNs };
+		samples.push_back(sample);
+		return true;
+	};
+	BOOST_CHECK(reader.replay(collect));
+	return samples;
+}
+
+// Channel 0 every 10 ns, channel 1 every 30 ns (in chunks of 4)
+static void writeTestCapture(const std::string& fileName)
+{
+	CaptureWriter writer(4);
+	BOOST_REQUIRE(writer.open(fileName, { "y0=", "y1=" }));
+	for (int i = 0; i < 12; i++)
+	{
+		writer.write(0, i, i * 10);
+		if (i % 3 == 0)
+		{
+			writer.write(1, -i, i * 10);
+		}
+	}
+	BOOST_CHECK(writer.close());
+}
+
+BOOST_AUTO_TEST_CASE(notACaptureFile)
+{
+	TempFile file;
+	FILE* f = fopen(file.name.c_str(), "wb");
+	fputs("y=1\ny=2\n", f);
+	fclose(f);
+
+	CaptureReader reader;
+	BOOST_CHECK(!reader.open(file.name));
+	BOOST_CHECK(!reader.open("/nonexistent/capture"));
+}
+
+BOOST_AUTO_TEST_CASE(roundTrip)
+{
+	TempFile file;
+	writeTestCapture(file.name);
+
+	CaptureReader reader;
+	BOOST_REQUIRE(reader.open(file.name));
+	BOOST_CHECK(reader.hasIndex());
+	BOOST_REQUIRE_EQUAL(2, reader.getChannelNames().size());
+	BOOST_CHECK_EQUAL("y1=", reader.getChannelNames()[1]);
+	BOOST_CHECK_EQUAL(16, reader.getNumSamples());
+	BOOST_CHECK_EQUAL(110, reader.getDurationNs());
+
+	std::vector<Sample> samples = replayAll(reader);
+	BOOST_REQUIRE_EQUAL(16, samples.size());
+
+	// In time order, ties in channel order
+	size_t expectedChannels[] = { 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0 };
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		BOOST_CHECK_EQUAL(expectedChannels[i], samples[i].channel);
+		if (i)
+		{
+			BOOST_CHECK_LE(samples[i-1].timeNs, samples[i].timeNs);
+		}
+	}
+
+	// Values are exact, and evenly spaced times are too
+	BOOST_CHECK_EQUAL(0, samples[0].value);
+	BOOST_CHECK_EQUAL(-3, samples[5].value);
+	BOOST_CHECK_EQUAL(30, samples[5].timeNs);
+	BOOST_CHECK_EQUAL(11, samples[15].value);
+	BOOST_CHECK_EQUAL(110, samples[15].timeNs);
+}
+
+BOOST_AUTO_TEST_CASE(unfinishedRecording)
+{
+	TempFile file;
+	writeTestCapture(file.name);
+
+	// As if the recording died before writing the index (of 4 chunks)
+	const off_t indexSize = 4 * sizeof(CaptureIndexEntry) + sizeof(CaptureFileFooter);
+	struct stat st;
+	BOOST_REQUIRE_EQUAL(0, stat(file.name.c_str(), &st));
+	BOOST_REQUIRE_EQUAL(0, truncate(file.name.c_str(), st.st_size - indexSize));
+
+	CaptureReader reader;
+	BOOST_REQUIRE(reader.open(file.name));
+	BOOST_CHECK(!reader.hasIndex());
+	BOOST_CHECK_EQUAL(16, reader.getNumSamples());
+	BOOST_CHECK_EQUAL(16, replayAll(reader).size());
+
+	// ...or even in the middle of the last chunk
+	BOOST_REQUIRE_EQUAL(0, truncate(file.name.c_str(), st.st_size - indexSize - 1));
+	CaptureReader truncatedReader;
+	BOOST_REQUIRE(truncatedReader.open(file.name));
+	BOOST_CHECK_EQUAL(12, truncatedReader.getNumSamples());
+	BOOST_CHECK_EQUAL(12, replayAll(truncatedReader).size());
+}
+
+BOOST_AUTO_TEST_CASE(stopEarly)
+{
+	TempFile file;
+	writeTestCapture(file.name);
+
+	CaptureReader reader;
+	BOOST_REQUIRE(reader.open(file.name));
+	int count = 0;
+	const auto & firstFive = [&](size_t, double, int64_t) { return ++count < 5; };
+	BOOST_CHECK(!reader.replay(firstFive));
+	BOOST_CHECK_EQUAL(5, count);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,326 @@
+/*
+ * CompressedStorageWaveform_Test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../StreamProcessors/CompressedStorageWaveform.hpp"
+
+#include <limits>
+#include <random>
+
+namespace {
+
+struct Collect {
+	std::vector<double> values;
+	void operator()(double value) { values.push_back(value); }
+};
+
+uint64_t bitsOf(double value)
+{
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+/** Pushes values, and checks that the history gives back the very same bits */
+void checkRoundTrip(const std::vector<double>& values)
+{
+	CompressedStorageWaveform<double> w(64);
+	for (double value : values)
+	{
+		w.push(value);
+	}
+	BOOST_REQUIRE_EQUAL(w.getNumSamples(), values.size());
+
+	Collect collect;
+	w.forEachSample(collect);
+	BOOST_REQUIRE_EQUAL(collect.values.size(), values.size());
+	for (size_t i = 0; i < values.size(); i++)
+	{
+		BOOST_REQUIRE_EQUAL(bitsOf(collect.values[i]), bitsOf(values[i]));
+	}
+}
+
+/** A slow sine printed with 5 significant digits, as in test_input.txt */
+std::vector<double> printedSine(size_t n)
+{
+	std::vector<double> values;
+	for (size_t i = 0; i < n; i++)
+	{
+		char text[32];
+		snprintf(text, sizeof(text), "%g", sin(i * 0.001));
+		values.push_back(atof(text));
+	}
+	return values;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(CompressedStorageWaveform_Test)
+
+
+BOOST_AUTO_TEST_CASE(roundTripPrintedSine)
+{
+	checkRoundTrip(printedSine(5000));
+}
+
+BOOST_AUTO_TEST_CASE(roundTripIntegers)
+{
+	std::vector<double> values;
+	for (int i = 0; i < 3000; i++)
+	{
+		values.push_back((i * 37) % 1000 - 500);
+	}
+	values.push_back(1e18);
+	values.push_back(-1e18);
+	checkRoundTrip(values);
+}
+
+BOOST_AUTO_TEST_CASE(roundTripRandomDoubles)
+{
+	std::mt19937_64 random(1);
+	std::vector<double> values;
+	for (int i = 0; i < 3000; i++)
+	{
+		values.push_back(std::uniform_real_distribution<double>(-1e6, 1e6)(random));
+	}
+	checkRoundTrip(values);
+}
+
+BOOST_AUTO_TEST_CASE(roundTripSpecialValues)
+{
+	std::vector<double> values = printedSine(1500);
+	values[3] = -0.0;
+	values[100] = std::numeric_limits<double>::quiet_NaN();
+	values[200] = std::numeric_limits<double>::infinity();
+	values[1100] = -std::numeric_limits<double>::infinity();
+	values[1101] = std::numeric_limits<double>::denorm_min();
+	values[1102] = std::numeric_limits<double>::max();
+	checkRoundTrip(values);
+}
+
+BOOST_AUTO_TEST_CASE(roundTripNegativeZero)
+{
+	// Blocks that would otherwise be stored as scaled integers
+	std::vector<double> values = printedSine(3000);
+	for (size_t i = 0; i < values.size(); i += 7)
+	{
+		values[i] = -0.0;
+	}
+	checkRoundTrip(values);
+	checkRoundTrip(std::vector<double>(1500, -0.0));
+}
+
+BOOST_AUTO_TEST_CASE(roundTripConstant)
+{
+	checkRoundTrip(std::vector<double>(2500, 0.1));
+}
+
+BOOST_AUTO_TEST_CASE(compressesPrintedNumbers)
+{
+	CompressedStorageWaveform<double> w;
+	for (double value : printedSine(100000))
+	{
+		w.push(value);
+	}
+	// At least 4 times smaller than the doubles
+	BOOST_CHECK_LT(w.getCompressedBytes() * 4, 100000 * sizeof(double));
+}
+
+BOOST_AUTO_TEST_CASE(viewMergesMinMax)
+{
+	CompressedStorageWaveform<double> w(4);
+	for (int i = 0; i < 16; i++)
+	{
+		w.push(i % 2 ? 100 + i : -i);
+	}
+	// 4 points of 4 samples each
+	const auto& view = w.getWaveform();
+	BOOST_REQUIRE_EQUAL(view.size(), 4);
+	for (int i = 0; i < 4; i++)
+	{
+		BOOST_CHECK_EQUAL(view[i].min, -(4 * i + 2));
+		BOOST_CHECK_EQUAL(view[i].max, 100 + 4 * i + 3);
+	}
+	BOOST_CHECK_EQUAL(w.getLastSample(), 115);
+}
+
+BOOST_AUTO_TEST_CASE(minMaxOfRanges)
+{
+	std::vector<double> values = printedSine(5000);
+	CompressedStorageWaveform<double> w;
+	for (double value : values)
+	{
+		w.push(value);
+	}
+
+	const uint64_t ranges[][2] = { { 0, 5000 }, { 10, 1 }, { 1000, 2048 }, { 1024, 1024 }, { 4090, 100 }, { 3000, 0 } };
+	for (const auto& range : ranges)
+	{
+		MinMax<double> expected;
+		for (uint64_t i = range[0]; i < std::min<uint64_t>(range[0] + range[1], values.size()); i++)
+		{
+			expected.update(values[i]);
+		}
+		MinMax<double> result = w.getMinMax(range[0], range[1]);
+		BOOST_CHECK_EQUAL(result.min, expected.min);
+		BOOST_CHECK_EQUAL(result.max, expected.max);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(historyLimitDropsOldest)
+{
+	CompressedStorageWaveform<double> w(64, 20000);
+	std::mt19937_64 random(2);
+	std::vector<double> values;
+	for (int i = 0; i < 20000; i++)
+	{
+		values.push_back(std::uniform_real_distribution<double>(-1, 1)(random));
+		w.push(values.back());
+	}
+	BOOST_CHECK_LE(w.getCompressedBytes(), 20000);
+	BOOST_REQUIRE_LT(w.getNumSamples(), values.size());
+
+	// What is left is the newest samples
+	Collect collect;
+	w.forEachSample(collect);
+	BOOST_REQUIRE_EQUAL(collect.values.size(), w.getNumSamples());
+	const size_t first = values.size() - collect.values.size();
+	for (size_t i = 0; i < collect.values.size(); i++)
+	{
+		BOOST_REQUIRE_EQUAL(collect.values[i], values[first + i]);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(rangesAfterDroppingBlocks)
+{
+	CompressedStorageWaveform<double> w(64, 20000);
+	std::vector<double> values = printedSine(20000);
+	for (double value : values)
+	{
+		w.push(value);
+	}
+	BOOST_REQUIRE_LT(w.getNumSamples(), values.size());
+	BOOST_CHECK_EQUAL(w.getTotalSamples(), values.size());
+	const size_t dropped = values.size() - w.getNumSamples();
+
+	const uint64_t ranges[][2] = { { 0, 10 }, { 1000, 3000 }, { 500, 1 }, { w.getNumSamples() - 5, 100 } };
+	for (const auto& range : ranges)
+	{
+		Collect collect;
+		w.forEachSample(range[0], range[1], collect);
+		MinMax<double> expected;
+		const uint64_t end = std::min<uint64_t>(range[0] + range[1], w.getNumSamples());
+		BOOST_REQUIRE_EQUAL(collect.values.size(), end - range[0]);
+		for (uint64_t i = range[0]; i < end; i++)
+		{
+			BOOST_REQUIRE_EQUAL(collect.values[i - range[0]], values[dropped + i]);
+			expected.update(values[dropped + i]);
+		}
+		MinMax<double> result = w.getMinMax(range[0], range[1]);
+		BOOST_CHECK_EQUAL(result.min, expected.min);
+		BOOST_CHECK_EQUAL(result.max, expected.max);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(columnsCoverAllSamples)
+{
+	// With 64 view points, the view is finer than the blocks for the fewer
+	// samples, and the blocks for the more
+	for (size_t numSamples : { size_t(20000), size_t(300000) })
+	{
+		std::vector<double> values = printedSine(numSamples);
+		for (size_t maxHistoryBytes : { size_t(0), size_t(20000) })
+		{
+			CompressedStorageWaveform<double> w(64, maxHistoryBytes);
+			for (double value : values)
+			{
+				w.push(value);
+			}
+
+			std::vector<MinMax<double> > columns;
+			w.getColumns(100, columns);
+			BOOST_REQUIRE_EQUAL(columns.size(), 100);
+
+			// Each column covers its part, and at most a view point or block more
+			const size_t part = numSamples / 100;
+			const size_t slack = std::max<size_t>(numSamples / 32, CompressedStorageWaveform<double>::BLOCK_SAMPLES);
+			for (size_t c = 0; c < columns.size(); c++)
+			{
+				MinMax<double> expected;
+				MinMax<double> bounds;
+				for (size_t i = c * part; i < (c + 1) * part; i++)
+				{
+					expected.update(values[i]);
+				}
+				for (size_t i = (c * part > slack) ? c * part - slack : 0; i < std::min(values.size(), (c + 1) * part + slack); i++)
+				{
+					bounds.update(values[i]);
+				}
+				BOOST_REQUIRE_LE(columns[c].min, expected.min);
+				BOOST_REQUIRE_GE(columns[c].max, expected.max);
+				BOOST_REQUIRE_GE(columns[c].min, bounds.min);
+				BOOST_REQUIRE_LE(columns[c].max, bounds.max);
+			}
+		}
+	}
+
+	// Fewer samples than columns
+	CompressedStorageWaveform<double> w(64);
+	w.push(1);
+	w.push(2);
+	std::vector<MinMax<double> > columns;
+	w.getColumns(100, columns);
+	BOOST_REQUIRE_EQUAL(columns.size(), 2);
+	BOOST_CHECK_EQUAL(columns[1].min, 2);
+}
+
+BOOST_AUTO_TEST_CASE(duplicateKeepsTheView)
+{
+	CompressedStorageWaveform<double> w(8);
+	for (int i = 0; i < 100; i++)
+	{
+		w.push(i);
+	}
+	std::unique_ptr<IWaveformStorage<double> > copy(w.duplicate());
+	BOOST_REQUIRE_EQUAL(copy->getWaveform().size(), w.getWaveform().size());
+	BOOST_CHECK_EQUAL(copy->getWaveform().back().max, w.getWaveform().back().max);
+	BOOST_CHECK_EQUAL(copy->getLastSample(), 99);
+}
+
+BOOST_AUTO_TEST_CASE(duplicateSharesTheHistory)
+{
+	CompressedStorageWaveform<double> w(8, 1 << 20);
+	std::mt19937_64 random(3);
+	std::vector<double> values;
+	for (int i = 0; i < 5000; i++)
+	{
+		values.push_back(std::uniform_real_distribution<double>(-1, 1)(random));
+		w.push(values.back());
+	}
+	std::unique_ptr<CompressedStorageWaveform<double> > copy(
+			static_cast<CompressedStorageWaveform<double>*>(w.duplicate()));
+
+	// Only pointers to the blocks are counted for the copy
+	BOOST_CHECK_GT(w.getCompressedBytes(), 20000);
+	BOOST_CHECK_LT(copy->memoryUsage(), 10000);
+	BOOST_CHECK_EQUAL(copy->getWaveform().size(), w.getWaveform().size());
+
+	// What the original gets later is not in the copy
+	for (int i = 0; i < 3000; i++)
+	{
+		w.push(2);
+	}
+	Collect collect;
+	copy->forEachSample(collect);
+	BOOST_CHECK(collect.values == values);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
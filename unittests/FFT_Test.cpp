@@ -0,0 +1,90 @@
+/*
+ * FFT_Test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../StreamProcessors/FFT.hpp"
+
+#include <random>
+
+
+BOOST_AUTO_TEST_SUITE(FFT_Test)
+
+
+BOOST_AUTO_TEST_CASE(powersOfTwo)
+{
+	BOOST_CHECK(FFT::isPowerOfTwo(2));
+	BOOST_CHECK(FFT::isPowerOfTwo(4096));
+	BOOST_CHECK(!FFT::isPowerOfTwo(0));
+	BOOST_CHECK(!FFT::isPowerOfTwo(1));
+	BOOST_CHECK(!FFT::isPowerOfTwo(1000));
+}
+
+BOOST_AUTO_TEST_CASE(impulseIsFlat)
+{
+	FFT fft(64);
+	std::vector<std::complex<double> > data(64);
+	data[0] = 1;
+	fft.transform(&data[0]);
+	for (const auto& value : data)
+	{
+		BOOST_CHECK_SMALL(std::abs(value - std::complex<double>(1, 0)), 1e-12);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(sameAsDiscreteFourierTransform)
+{
+	std::mt19937 random(1);
+	std::uniform_real_distribution<double> uniform(-1, 1);
+
+	for (size_t size = 2; size <= 512; size *= 2)
+	{
+		std::vector<std::complex<double> > data(size);
+		for (auto& value : data)
+		{
+			value = std::complex<double>(uniform(random), uniform(random));
+		}
+
+		std::vector<std::complex<double> > expected(size);
+		for (size_t k = 0; k < size; k++)
+		{
+			for (size_t n = 0; n < size; n++)
+			{
+				expected[k] += data[n] * std::polar(1.0, -2 * M_PI * double(k * n % size) / size);
+			}
+		}
+
+		FFT fft(size);
+		fft.transform(&data[0]);
+		for (size_t k = 0; k < size; k++)
+		{
+			BOOST_CHECK_SMALL(std::abs(data[k] - expected[k]), 1e-9);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(cosineLandsInItsBins)
+{
+	const size_t size = 256;
+	FFT fft(size);
+	std::vector<std::complex<double> > data(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		data[i] = cos(2 * M_PI * 10 * i / size);
+	}
+	fft.transform(&data[0]);
+	for (size_t k = 0; k < size; k++)
+	{
+		double expected = (k == 10 || k == size - 10) ? size / 2.0 : 0;
+		BOOST_CHECK_SMALL(std::abs(data[k]) - expected, 1e-9);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
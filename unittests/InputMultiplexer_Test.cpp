@@ -0,0 +1,188 @@
+/*
+ * InputMultiplexer_Test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../InputMultiplexer.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+
+
+BOOST_AUTO_TEST_SUITE(InputMultiplexer_Test)
+
+
+// What was read, per stream
+struct Collector {
+	std::map<size_t, std::string> data;
+	std::map<size_t, size_t> sourceOfStream;
+	std::vector<std::string> datagrams;
+	size_t numEnded;
+
+	Collector() : numEnded(0)
+	{ }
+
+	void operator()(size_t source, size_t stream, const char* bytes, size_t size)
+	{
+		sourceOfStream[stream] = source;
+		if (!bytes)
+		{
+			numEnded++;
+			return;
+		}
+		data[stream].append(bytes, size);
+		datagrams.push_back(std::string(bytes, size));
+	}
+};
+
+static int connectLoopback(int type, int port)
+{
+	struct sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	int fd = socket(AF_INET, type, 0);
+	BOOST_REQUIRE(fd >= 0);
+	BOOST_REQUIRE_EQUAL(0, connect(fd, (struct sockaddr*)&address, sizeof(address)));
+	return fd;
+}
+
+static int findFreePort(int type)
+{
+	int fd = socket(AF_INET, type, 0);
+	struct sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	bind(fd, (struct sockaddr*)&address, sizeof(address));
+	socklen_t length = sizeof(address);
+	getsockname(fd, (struct sockaddr*)&address, &length);
+	close(fd);
+	return ntohs(address.sin_port);
+}
+
+BOOST_AUTO_TEST_CASE(unknownFile)
+{
+	InputMultiplexer dut;
+	BOOST_CHECK_EQUAL(-1, dut.addSource("/nonexistent/file"));
+	BOOST_CHECK_EQUAL(0, dut.getNumSources());
+}
+
+BOOST_AUTO_TEST_CASE(regularFileAndPipe)
+{
+	char fileName[] = "/tmp/InputMultiplexer_TestXXXXXX";
+	int fileFd = mkstemp(fileName);
+	BOOST_REQUIRE(fileFd >= 0);
+	BOOST_REQUIRE_EQUAL(6, write(fileFd, "a=1\nb=", 6));
+	close(fileFd);
+
+	int pipeFds[2];
+	BOOST_REQUIRE_EQUAL(0, pipe(pipeFds));
+	char pipeName[64];
+	snprintf(pipeName, sizeof(pipeName), "/proc/self/fd/%d", pipeFds[0]);
+
+	// Small reads, to get several reads of the file
+	InputMultiplexer dut(4);
+	BOOST_CHECK_EQUAL(0, dut.addSource(fileName));
+	BOOST_CHECK_EQUAL(1, dut.addSource(pipeName));
+	close(pipeFds[0]);
+	unlink(fileName);
+	BOOST_CHECK(!dut.isDatagram(0));
+
+	BOOST_REQUIRE_EQUAL(5, write(pipeFds[1], "hello", 5));
+	close(pipeFds[1]);
+
+	Collector collector;
+	int rounds = 0;
+	while (dut.read(collector, 100) && rounds < 100)
+	{
+		rounds++;
+	}
+	BOOST_CHECK_EQUAL(0, dut.getNumOpen());
+	BOOST_CHECK_EQUAL(2, collector.numEnded);
+	BOOST_CHECK_EQUAL("a=1\nb=", collector.data[0]);
+	BOOST_CHECK_EQUAL("hello", collector.data[1]);
+	BOOST_CHECK_EQUAL(1, collector.sourceOfStream[1]);
+}
+
+BOOST_AUTO_TEST_CASE(udpDatagrams)
+{
+	int port = findFreePort(SOCK_DGRAM);
+	InputMultiplexer dut;
+	BOOST_REQUIRE_EQUAL(0, dut.addSource("udp:127.0.0.1:" + std::to_string(port)));
+	BOOST_CHECK(dut.isDatagram(0));
+
+	int fd = connectLoopback(SOCK_DGRAM, port);
+	const char* messages[] = { "y=1\n", "y=2\ny=3\n", "y=4" };
+	for (auto message : messages)
+	{
+		BOOST_REQUIRE_EQUAL(ssize_t(strlen(message)), send(fd, message, strlen(message), 0));
+	}
+	close(fd);
+
+	Collector collector;
+	for (int rounds = 0; rounds < 20 && collector.datagrams.size() < 3; rounds++)
+	{
+		dut.read(collector, 100);
+	}
+	BOOST_REQUIRE_EQUAL(3, collector.datagrams.size());
+	for (size_t i = 0; i < 3; i++)
+	{
+		BOOST_CHECK_EQUAL(messages[i], collector.datagrams[i]);
+	}
+
+	// Nothing ends a UDP input
+	BOOST_CHECK_EQUAL(1, dut.getNumOpen());
+}
+
+BOOST_AUTO_TEST_CASE(tcpConnections)
+{
+	int port = findFreePort(SOCK_STREAM);
+	InputMultiplexer dut;
+	BOOST_REQUIRE_EQUAL(0, dut.addSource("tcp:127.0.0.1:" + std::to_string(port)));
+
+	int first = connectLoopback(SOCK_STREAM, port);
+	int second = connectLoopback(SOCK_STREAM, port);
+	BOOST_REQUIRE_EQUAL(4, send(first, "a=1\n", 4, 0));
+	BOOST_REQUIRE_EQUAL(4, send(second, "b=2\n", 4, 0));
+	close(first);
+	close(second);
+
+	Collector collector;
+	for (int rounds = 0; rounds < 20 && collector.numEnded < 2; rounds++)
+	{
+		dut.read(collector, 100);
+	}
+	BOOST_CHECK_EQUAL(2, collector.numEnded);
+
+	// Each connection is a stream of its own, of the same source
+	std::vector<std::string> received;
+	for (const auto& stream : collector.data)
+	{
+		BOOST_CHECK_EQUAL(0, collector.sourceOfStream[stream.first]);
+		received.push_back(stream.second);
+	}
+	std::sort(received.begin(), received.end());
+	BOOST_REQUIRE_EQUAL(2, received.size());
+	BOOST_CHECK_EQUAL("a=1\n", received[0]);
+	BOOST_CHECK_EQUAL("b=2\n", received[1]);
+	BOOST_CHECK_EQUAL(1, dut.getNumOpen());
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
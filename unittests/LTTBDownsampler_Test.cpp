@@ -0,0 +1,86 @@
+/*
+ * LTTBDownsampler_Test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../StreamProcessors/LTTBDownsampler.hpp"
+
+#include <math.h>
+
+
+BOOST_AUTO_TEST_SUITE(LTTBDownsampler_Test)
+
+
+BOOST_AUTO_TEST_CASE(shortWaveformUntouched)
+{
+	std::vector<MinMax<double> > waveform;
+	waveform.push_back(MinMax<double>(1, 1));
+	waveform.push_back(MinMax<double>(2, 2));
+	waveform.push_back(MinMax<double>(3, 3));
+
+	LTTBDownsampler<double> dut;
+	const auto& points = dut.downsample(waveform, 10);
+	BOOST_REQUIRE_EQUAL(3, points.size());
+	BOOST_CHECK_EQUAL(0, points[0].x);
+	BOOST_CHECK_EQUAL(3, points[2].y);
+}
+
+BOOST_AUTO_TEST_CASE(flattenZigZagsContinuously)
+{
+	std::vector<MinMax<double> > waveform;
+	waveform.push_back(MinMax<double>(0, 10));
+	waveform.push_back(MinMax<double>(8, 9));
+
+	std::vector<LTTBDownsampler<double>::Point> points;
+	LTTBDownsampler<double>::flatten(waveform, points);
+
+	BOOST_REQUIRE_EQUAL(4, points.size());
+	BOOST_CHECK_EQUAL(0, points[0].y);
+	BOOST_CHECK_EQUAL(10, points[1].y);
+	BOOST_CHECK_EQUAL(9, points[2].y); // Closest to previous point first
+	BOOST_CHECK_EQUAL(8, points[3].y);
+	BOOST_CHECK_EQUAL(1.5, points[3].x);
+}
+
+BOOST_AUTO_TEST_CASE(keepsEndpointsAndPeak)
+{
+	std::vector<MinMax<double> > waveform;
+	for (int i = 0; i < 10000; i++)
+	{
+		double val = (i == 4321) ? 100 : sin(i * 0.01);
+		waveform.push_back(MinMax<double>(val, val));
+	}
+
+	LTTBDownsampler<double> dut;
+	const auto& points = dut.downsample(waveform, 200);
+	BOOST_REQUIRE_EQUAL(200, points.size());
+	BOOST_CHECK_EQUAL(0, points.front().x);
+	BOOST_CHECK_EQUAL(9999, points.back().x);
+
+	bool peakFound = false;
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		if (points[i].y == 100) { peakFound = true; }
+		if (i > 0) { BOOST_CHECK(points[i].x > points[i-1].x); }
+	}
+	BOOST_CHECK(peakFound);
+}
+
+BOOST_AUTO_TEST_CASE(negativeEnvelopeKept)
+{
+	// Min/max pairs of negative values must not be clamped towards zero
+	MinMax<double> val;
+	val.update(-3);
+	val.update(-2);
+	BOOST_CHECK_EQUAL(-3, val.min);
+	BOOST_CHECK_EQUAL(-2, val.max);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
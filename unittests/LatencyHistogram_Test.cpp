@@ -0,0 +1,100 @@
+/*
+ * LatencyHistogram_Test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../StreamProcessors/LatencyHistogram.hpp"
+
+#include <limits>
+
+
+BOOST_AUTO_TEST_SUITE(LatencyHistogram_Test)
+
+
+BOOST_AUTO_TEST_CASE(empty)
+{
+	LatencyHistogram dut;
+	BOOST_CHECK_EQUAL(0, dut.getCount());
+	BOOST_CHECK_EQUAL(0, dut.getMax());
+	BOOST_CHECK_EQUAL(0, dut.getPercentile(50));
+}
+
+BOOST_AUTO_TEST_CASE(bucketBoundaries)
+{
+	BOOST_CHECK_EQUAL(127, LatencyHistogram::bucketIndex(127));
+	BOOST_CHECK_EQUAL(128, LatencyHistogram::bucketIndex(128));
+	BOOST_CHECK_EQUAL(128, LatencyHistogram::bucketIndex(129));
+	BOOST_CHECK_EQUAL(191, LatencyHistogram::bucketIndex(255));
+	BOOST_CHECK_EQUAL(192, LatencyHistogram::bucketIndex(256));
+
+	BOOST_CHECK_EQUAL(129, LatencyHistogram::bucketUpperBound(128));
+	BOOST_CHECK_EQUAL(255, LatencyHistogram::bucketUpperBound(191));
+	BOOST_CHECK_EQUAL(259, LatencyHistogram::bucketUpperBound(192));
+
+	const uint64_t largest = std::numeric_limits<uint64_t>::max();
+	BOOST_CHECK_EQUAL(largest, LatencyHistogram::bucketUpperBound(LatencyHistogram::bucketIndex(largest)));
+
+	// Every value is within its bucket, and buckets are within 1/64 of their values
+	for (uint64_t value = 1; value < largest / 3; value = value * 3 + 1)
+	{
+		uint64_t upper = LatencyHistogram::bucketUpperBound(LatencyHistogram::bucketIndex(value));
+		BOOST_CHECK_LE(value, upper);
+		BOOST_CHECK_LE(upper - value, value / 64);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(smallValuesAreExact)
+{
+	LatencyHistogram dut;
+	for (uint64_t value = 1; value <= 100; value++)
+	{
+		dut.record(value);
+	}
+	BOOST_CHECK_EQUAL(100, dut.getCount());
+	BOOST_CHECK_EQUAL(1, dut.getMin());
+	BOOST_CHECK_EQUAL(100, dut.getMax());
+	BOOST_CHECK_CLOSE(50.5, dut.getMean(), 1e-9);
+	BOOST_CHECK_EQUAL(50, dut.getPercentile(50));
+	BOOST_CHECK_EQUAL(99, dut.getPercentile(99));
+	BOOST_CHECK_EQUAL(100, dut.getPercentile(100));
+	BOOST_CHECK_EQUAL(1, dut.getPercentile(0));
+}
+
+BOOST_AUTO_TEST_CASE(largeValuesWithinPrecision)
+{
+	LatencyHistogram dut;
+	for (int i = 0; i < 990; i++)
+	{
+		dut.record(1000000); // 1 ms
+	}
+	for (int i = 0; i < 10; i++)
+	{
+		dut.record(25000000); // 25 ms
+	}
+	dut.record(40000000);
+
+	BOOST_CHECK_CLOSE(1e6, double(dut.getPercentile(50)), 1.6);
+	BOOST_CHECK_CLOSE(1e6, double(dut.getPercentile(98)), 1.6);
+	BOOST_CHECK_CLOSE(25e6, double(dut.getPercentile(99.5)), 1.6);
+	BOOST_CHECK_EQUAL(40000000, dut.getPercentile(100));
+	BOOST_CHECK_EQUAL(40000000, dut.getMax());
+}
+
+BOOST_AUTO_TEST_CASE(clear)
+{
+	LatencyHistogram dut;
+	dut.record(5);
+	dut.clear();
+	BOOST_CHECK_EQUAL(0, dut.getCount());
+	BOOST_CHECK_EQUAL(0, dut.getPercentile(99));
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
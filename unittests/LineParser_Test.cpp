@@ -0,0 +1,266 @@
+/*
+ * LineParser_Test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../LineParser.hpp"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+BOOST_AUTO_TEST_SUITE(LineParser_Test)
+
+
+struct Collector {
+	std::vector<std::pair<size_t, double> > samples;
+	void operator()(size_t channel, double value)
+	{
+		samples.push_back(std::make_pair(channel, value));
+	}
+};
+
+BOOST_AUTO_TEST_CASE(csvColumns)
+{
+	ColumnParser dut(',');
+	dut.addColumn(1, 0);
+	dut.addColumn(2, 1);
+	dut.addColumn(4, 2);
+
+	Collector collector;
+	dut.parse("0.5,1,-2.5,9,3e2", collector);
+	BOOST_REQUIRE_EQUAL(3, collector.samples.size());
+	BOOST_CHECK_EQUAL(0, collector.samples[0].first);
+	BOOST_CHECK_EQUAL(1, collector.samples[0].second);
+	BOOST_CHECK_EQUAL(1, collector.samples[1].first);
+	BOOST_CHECK_EQUAL(-2.5, collector.samples[1].second);
+	BOOST_CHECK_EQUAL(2, collector.samples[2].first);
+	BOOST_CHECK_EQUAL(300, collector.samples[2].second);
+}
+
+BOOST_AUTO_TEST_CASE(missingAndNonNumericFields)
+{
+	ColumnParser dut(',');
+	dut.addColumn(1, 0);
+	dut.addColumn(2, 1);
+	dut.addColumn(3, 2);
+
+	Collector collector;
+	dut.parse("t,a,b,c", collector);
+	dut.parse("1,,7", collector);
+	BOOST_REQUIRE_EQUAL(1, collector.samples.size());
+	BOOST_CHECK_EQUAL(1, collector.samples[0].first);
+	BOOST_CHECK_EQUAL(7, collector.samples[0].second);
+}
+
+BOOST_AUTO_TEST_CASE(blankFieldsGiveNoSample)
+{
+	ColumnParser dut('\t');
+	dut.addColumn(1, 0);
+	dut.addColumn(2, 1);
+
+	Collector collector;
+	dut.parse("1\t \t3", collector);
+	dut.parse("1\t\t4", collector);
+	dut.parse("1\t 5\t 6", collector); // Blanks before a number are fine
+	BOOST_REQUIRE_EQUAL(4, collector.samples.size());
+	BOOST_CHECK_EQUAL(1, collector.samples[0].first);
+	BOOST_CHECK_EQUAL(3, collector.samples[0].second);
+	BOOST_CHECK_EQUAL(1, collector.samples[1].first);
+	BOOST_CHECK_EQUAL(4, collector.samples[1].second);
+	BOOST_CHECK_EQUAL(0, collector.samples[2].first);
+	BOOST_CHECK_EQUAL(5, collector.samples[2].second);
+	BOOST_CHECK_EQUAL(6, collector.samples[3].second);
+}
+
+BOOST_AUTO_TEST_CASE(whitespaceColumns)
+{
+	ColumnParser dut;
+	dut.addColumn(0, 5);
+	dut.addColumn(2, 6);
+
+	Collector collector;
+	dut.parse("  1 \t 2   3  ", collector);
+	BOOST_REQUIRE_EQUAL(2, collector.samples.size());
+	BOOST_CHECK_EQUAL(5, collector.samples[0].first);
+	BOOST_CHECK_EQUAL(1, collector.samples[0].second);
+	BOOST_CHECK_EQUAL(6, collector.samples[1].first);
+	BOOST_CHECK_EQUAL(3, collector.samples[1].second);
+}
+
+BOOST_AUTO_TEST_CASE(columnList)
+{
+	std::vector<size_t> columns = ColumnParser::parseColumnList("2,3,5");
+	BOOST_REQUIRE_EQUAL(3, columns.size());
+	BOOST_CHECK_EQUAL(1, columns[0]);
+	BOOST_CHECK_EQUAL(2, columns[1]);
+	BOOST_CHECK_EQUAL(4, columns[2]);
+
+	columns = ColumnParser::parseColumnList("2-4,7");
+	BOOST_REQUIRE_EQUAL(4, columns.size());
+	BOOST_CHECK_EQUAL(3, columns[2]);
+	BOOST_CHECK_EQUAL(6, columns[3]);
+
+	BOOST_CHECK(ColumnParser::parseColumnList("").empty());
+	BOOST_CHECK(ColumnParser::parseColumnList("0").empty());
+	BOOST_CHECK(ColumnParser::parseColumnList("3-2").empty());
+	BOOST_CHECK(ColumnParser::parseColumnList("2,x").empty());
+	BOOST_CHECK(ColumnParser::parseColumnList("2,").empty());
+}
+
+/** Gives new keys channels from 10 on, and refuses keys starting with '_' */
+struct NewKeys {
+	std::vector<std::string> keys;
+	size_t operator()(const std::string& key)
+	{
+		keys.push_back(key);
+		return key[0] == '_' ? KeyValueParser::NO_CHANNEL : 10 + keys.size() - 1;
+	}
+};
+
+BOOST_AUTO_TEST_CASE(keyValueDiscovery)
+{
+	KeyValueParser dut;
+	dut.addKey("y", 3);
+
+	Collector collector;
+	NewKeys newKeys;
+	dut.parse("y=0.5", collector, newKeys);
+	dut.parse("t=12 a=1.5,b=-3", collector, newKeys);
+	dut.parse("a=2;t=13", collector, newKeys);
+	BOOST_CHECK_EQUAL(3, dut.getNumKeys() - 1); // t, a and b
+
+	BOOST_REQUIRE_EQUAL(3, newKeys.keys.size());
+	BOOST_CHECK_EQUAL("t", newKeys.keys[0]);
+	BOOST_CHECK_EQUAL("a", newKeys.keys[1]);
+	BOOST_CHECK_EQUAL("b", newKeys.keys[2]);
+
+	const std::pair<size_t, double> expected[] = {
+			{ 3, 0.5 }, { 10, 12 }, { 11, 1.5 }, { 12, -3 }, { 11, 2 }, { 10, 13 } };
+	BOOST_REQUIRE_EQUAL(6, collector.samples.size());
+	for (size_t i = 0; i < 6; i++)
+	{
+		BOOST_CHECK_EQUAL(expected[i].first, collector.samples[i].first);
+		BOOST_CHECK_EQUAL(expected[i].second, collector.samples[i].second);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(keyValueSkipsOtherText)
+{
+	KeyValueParser dut;
+	Collector collector;
+	NewKeys newKeys;
+	dut.parse("", collector, newKeys);
+	dut.parse("hello world", collector, newKeys);
+	dut.parse("=5 msg=hi x= 7 _hidden=1 _hidden=2", collector, newKeys);
+	dut.parse("  z=4\r", collector, newKeys);
+
+	// _hidden was asked about once, and gave no samples
+	BOOST_REQUIRE_EQUAL(2, newKeys.keys.size());
+	BOOST_CHECK_EQUAL("_hidden", newKeys.keys[0]);
+	BOOST_CHECK_EQUAL("z", newKeys.keys[1]);
+	BOOST_REQUIRE_EQUAL(1, collector.samples.size());
+	BOOST_CHECK_EQUAL(4, collector.samples[0].second);
+}
+
+BOOST_AUTO_TEST_CASE(keyValueManyKeys)
+{
+	KeyValueParser dut(300);
+	Collector collector;
+	NewKeys newKeys;
+	for (int round = 0; round < 2; round++)
+	{
+		for (int i = 0; i < 700; i++)
+		{
+			dut.parse("key" + std::to_string(i) + "=" + std::to_string(i), collector, newKeys);
+		}
+	}
+	// 300 keys in the table and 300 in the overflow map are asked about
+	// once. The last 100 are never asked about, and give no samples.
+	BOOST_CHECK_EQUAL(300, dut.getNumKeys());
+	BOOST_REQUIRE_EQUAL(600, newKeys.keys.size());
+	BOOST_CHECK_EQUAL("key599", newKeys.keys.back());
+	BOOST_REQUIRE_EQUAL(1200, collector.samples.size());
+	BOOST_CHECK_EQUAL(10 + 123, collector.samples[600 + 123].first);
+	BOOST_CHECK_EQUAL(10 + 450, collector.samples[600 + 450].first);
+	BOOST_CHECK_EQUAL(450, collector.samples[600 + 450].second);
+}
+
+BOOST_AUTO_TEST_CASE(keyValueOverflowKeysAskedOnce)
+{
+	// Keys refused once the table is full are not asked about again
+	KeyValueParser dut(2);
+	Collector collector;
+	NewKeys newKeys;
+	for (int round = 0; round < 3; round++)
+	{
+		dut.parse("a=1 b=2 _c=3 _d=4", collector, newKeys);
+	}
+	BOOST_CHECK_EQUAL(2, dut.getNumKeys());
+	BOOST_REQUIRE_EQUAL(4, newKeys.keys.size());
+	BOOST_CHECK_EQUAL("_d", newKeys.keys[3]);
+	BOOST_CHECK_EQUAL(6, collector.samples.size());
+}
+
+
+struct LineCollector {
+	std::vector<std::string> lines;
+	void operator()(const char* line, size_t size)
+	{
+		BOOST_CHECK_EQUAL(line[size], '\0');
+		lines.push_back(std::string(line, size));
+	}
+};
+
+BOOST_AUTO_TEST_CASE(linesSplitOverChunks)
+{
+	const std::string text = "y=1\ny=22\n\ny=333\nlast";
+	for (size_t chunkSize = 1; chunkSize <= text.size(); chunkSize++)
+	{
+		LineSplitter splitter;
+		LineCollector collector;
+		for (size_t offset = 0; offset < text.size(); offset += chunkSize)
+		{
+			std::vector<char> chunk(text.begin() + offset, text.begin() + std::min(text.size(), offset + chunkSize));
+			splitter.push(&chunk[0], chunk.size(), collector);
+		}
+		splitter.finish(collector);
+
+		BOOST_REQUIRE_EQUAL(collector.lines.size(), 5);
+		BOOST_CHECK_EQUAL(collector.lines[0], "y=1");
+		BOOST_CHECK_EQUAL(collector.lines[1], "y=22");
+		BOOST_CHECK_EQUAL(collector.lines[2], "");
+		BOOST_CHECK_EQUAL(collector.lines[3], "y=333");
+		BOOST_CHECK_EQUAL(collector.lines[4], "last");
+	}
+}
+
+BOOST_AUTO_TEST_CASE(lineViewsEndAtTheNewline)
+{
+	PrefixMatcher matcher;
+	matcher.addPrefix("y=", 0);
+	Collector collector;
+	const auto & match = [&](const char* line, size_t size) { matcher.match(line, size, collector); };
+
+	// The number of an empty "y=" is not looked for on the next line
+	char text[] = "y=\n5\ny=2.5\ny=";
+	LineSplitter splitter;
+	splitter.push(text, sizeof(text) - 1, match);
+	splitter.finish(match);
+
+	BOOST_REQUIRE_EQUAL(collector.samples.size(), 3);
+	BOOST_CHECK_EQUAL(collector.samples[0].second, 0);
+	BOOST_CHECK_EQUAL(collector.samples[1].second, 2.5);
+	BOOST_CHECK_EQUAL(collector.samples[2].second, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
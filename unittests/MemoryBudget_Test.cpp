@@ -0,0 +1,68 @@
+/*
+ * MemoryBudget_Test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../MemoryBudget.hpp"
+
+
+BOOST_AUTO_TEST_SUITE(MemoryBudget_Test)
+
+
+BOOST_AUTO_TEST_CASE(parseSize)
+{
+	size_t bytes = 0;
+	BOOST_CHECK(MemoryBudget::parseSize("1000000", bytes));
+	BOOST_CHECK_EQUAL(1000000, bytes);
+	BOOST_CHECK(MemoryBudget::parseSize("64k", bytes));
+	BOOST_CHECK_EQUAL(64 * 1024, bytes);
+	BOOST_CHECK(MemoryBudget::parseSize("512M", bytes));
+	BOOST_CHECK_EQUAL(512 * 1024 * 1024, bytes);
+	BOOST_CHECK(MemoryBudget::parseSize("2GB", bytes));
+	BOOST_CHECK_EQUAL(size_t(2) << 30, bytes);
+
+	BOOST_CHECK(!MemoryBudget::parseSize("", bytes));
+	BOOST_CHECK(!MemoryBudget::parseSize("M", bytes));
+	BOOST_CHECK(!MemoryBudget::parseSize("-5M", bytes));
+	BOOST_CHECK(!MemoryBudget::parseSize("5X", bytes));
+	BOOST_CHECK(!MemoryBudget::parseSize("5M extra", bytes));
+}
+
+BOOST_AUTO_TEST_CASE(pointsPerChannel)
+{
+	MemoryBudget dut(1 << 20);
+
+	// 4 channels of 1000 fixed bytes, 48 bytes per point: (1048576 - 4000) / 4 / 48
+	BOOST_CHECK_EQUAL(5440, dut.pointsPerChannel(4, 48, 1000));
+
+	// Rounded down to an even number
+	BOOST_CHECK_EQUAL(0, dut.pointsPerChannel(1, 1 << 20, 0));
+	BOOST_CHECK_EQUAL(2, dut.pointsPerChannel(1, 1 << 18, 1));
+
+	// Not even the fixed part fits
+	BOOST_CHECK_EQUAL(0, dut.pointsPerChannel(2, 16, 1 << 19));
+}
+
+BOOST_AUTO_TEST_CASE(accounting)
+{
+	MemoryBudget unlimited;
+	unlimited.setUsed(size_t(1) << 40);
+	BOOST_CHECK(!unlimited.isExceeded());
+
+	MemoryBudget dut(1000);
+	dut.setUsed(1000);
+	BOOST_CHECK(!dut.isExceeded());
+	dut.setUsed(1001);
+	BOOST_CHECK(dut.isExceeded());
+	BOOST_CHECK_EQUAL(1001, dut.getUsed());
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,112 @@
+/*
+ * OverloadBuffer_Test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../StreamProcessors/OverloadBuffer.hpp"
+
+#include <vector>
+
+
+BOOST_AUTO_TEST_SUITE(OverloadBuffer_Test)
+
+
+static std::vector<int> flushed(OverloadBuffer<int>& dut)
+{
+	std::vector<int> result;
+	const auto & collect = [&](int val) { result.push_back(val); };
+	dut.flush(collect);
+	return result;
+}
+
+BOOST_AUTO_TEST_CASE(keepsOrderBelowCapacity)
+{
+	OverloadBuffer<int> dut(OverloadBuffer<int>::DROP_OLDEST, 8);
+	BOOST_CHECK(dut.empty());
+	for (int i = 0; i < 5; i++)
+	{
+		BOOST_CHECK_EQUAL(0, dut.push(i));
+	}
+	BOOST_CHECK_EQUAL(5, dut.size());
+
+	std::vector<int> expected = { 0, 1, 2, 3, 4 };
+	std::vector<int> result = flushed(dut);
+	BOOST_CHECK_EQUAL_COLLECTIONS(expected.begin(), expected.end(), result.begin(), result.end());
+	BOOST_CHECK(dut.empty());
+}
+
+BOOST_AUTO_TEST_CASE(dropOldest)
+{
+	OverloadBuffer<int> dut(OverloadBuffer<int>::DROP_OLDEST, 4);
+	size_t lost = 0;
+	for (int i = 0; i < 7; i++)
+	{
+		lost += dut.push(i);
+	}
+	BOOST_CHECK_EQUAL(3, lost);
+
+	std::vector<int> expected = { 3, 4, 5, 6 };
+	std::vector<int> result = flushed(dut);
+	BOOST_CHECK_EQUAL_COLLECTIONS(expected.begin(), expected.end(), result.begin(), result.end());
+}
+
+BOOST_AUTO_TEST_CASE(dropNewest)
+{
+	OverloadBuffer<int> dut(OverloadBuffer<int>::DROP_NEWEST, 4);
+	size_t lost = 0;
+	for (int i = 0; i < 7; i++)
+	{
+		lost += dut.push(i);
+	}
+	BOOST_CHECK_EQUAL(3, lost);
+
+	std::vector<int> expected = { 0, 1, 2, 3 };
+	std::vector<int> result = flushed(dut);
+	BOOST_CHECK_EQUAL_COLLECTIONS(expected.begin(), expected.end(), result.begin(), result.end());
+}
+
+BOOST_AUTO_TEST_CASE(decimateKeepsMinMaxInOrder)
+{
+	OverloadBuffer<int> dut(OverloadBuffer<int>::DECIMATE, 8);
+	int samples[] = { 5, 9, 1, 4,   7, 2, 3, 8 };
+	size_t lost = 0;
+	for (auto sample : samples)
+	{
+		lost += dut.push(sample);
+	}
+	BOOST_CHECK_EQUAL(0, lost);
+
+	// Full, so the next push reduces each 4 samples to their max and min
+	BOOST_CHECK_EQUAL(4, dut.push(6));
+
+	std::vector<int> expected = { 9, 1, 2, 8, 6 };
+	std::vector<int> result = flushed(dut);
+	BOOST_CHECK_EQUAL_COLLECTIONS(expected.begin(), expected.end(), result.begin(), result.end());
+}
+
+BOOST_AUTO_TEST_CASE(decimateRepeatedly)
+{
+	OverloadBuffer<int> dut(OverloadBuffer<int>::DECIMATE, 4);
+	int samples[] = { 3, 0, 4, 2 };
+	for (auto sample : samples)
+	{
+		dut.push(sample);
+	}
+	BOOST_CHECK_EQUAL(2, dut.push(1));
+	BOOST_CHECK_EQUAL(0, dut.push(5));
+	BOOST_CHECK_EQUAL(2, dut.push(6));
+
+	std::vector<int> expected = { 0, 5, 6 };
+	std::vector<int> result = flushed(dut);
+	BOOST_CHECK_EQUAL_COLLECTIONS(expected.begin(), expected.end(), result.begin(), result.end());
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,91 @@
+/*
+ * P2Quantile_Test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../StreamProcessors/P2Quantile.hpp"
+
+#include <random>
+
+
+BOOST_AUTO_TEST_SUITE(P2Quantile_Test)
+
+
+BOOST_AUTO_TEST_CASE(fewSamplesAreExact)
+{
+	P2Quantile median(0.5);
+	BOOST_CHECK_EQUAL(median.getQuantile(), 0);
+	median.push(3);
+	BOOST_CHECK_EQUAL(median.getQuantile(), 3);
+	median.push(1);
+	median.push(2);
+	BOOST_CHECK_EQUAL(median.getQuantile(), 2);
+	median.push(10);
+	median.push(-5);
+	BOOST_CHECK_EQUAL(median.getQuantile(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(uniform)
+{
+	std::mt19937 random(1);
+	std::uniform_real_distribution<double> uniform(0, 100);
+	P2Quantile p1(0.01), p50(0.5), p99(0.99);
+	for (int i = 0; i < 100000; i++)
+	{
+		double value = uniform(random);
+		p1.push(value);
+		p50.push(value);
+		p99.push(value);
+	}
+	BOOST_CHECK_EQUAL(p50.getCount(), 100000);
+	BOOST_CHECK_SMALL(p1.getQuantile() - 1, 0.5);
+	BOOST_CHECK_SMALL(p50.getQuantile() - 50, 0.5);
+	BOOST_CHECK_SMALL(p99.getQuantile() - 99, 0.5);
+}
+
+BOOST_AUTO_TEST_CASE(normal)
+{
+	std::mt19937 random(2);
+	std::normal_distribution<double> normal(10, 2);
+	P2Quantile p1(0.01), p50(0.5), p99(0.99);
+	for (int i = 0; i < 100000; i++)
+	{
+		double value = normal(random);
+		p1.push(value);
+		p50.push(value);
+		p99.push(value);
+	}
+	// 10 -+ 2.326 standard deviations
+	BOOST_CHECK_SMALL(p1.getQuantile() - 5.347, 0.1);
+	BOOST_CHECK_SMALL(p50.getQuantile() - 10, 0.05);
+	BOOST_CHECK_SMALL(p99.getQuantile() - 14.653, 0.1);
+}
+
+BOOST_AUTO_TEST_CASE(sortedInput)
+{
+	P2Quantile p50(0.5);
+	for (int i = 0; i <= 10000; i++)
+	{
+		p50.push(i);
+	}
+	BOOST_CHECK_SMALL(p50.getQuantile() - 5000, 50.0);
+}
+
+BOOST_AUTO_TEST_CASE(constant)
+{
+	P2Quantile p99(0.99);
+	for (int i = 0; i < 1000; i++)
+	{
+		p99.push(7);
+	}
+	BOOST_CHECK_EQUAL(p99.getQuantile(), 7);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
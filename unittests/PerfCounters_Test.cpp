@@ -0,0 +1,75 @@
+/*
+ * PerfCounters_Test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../PerfCounters.hpp"
+
+#include <thread>
+#include <vector>
+
+
+BOOST_AUTO_TEST_SUITE(PerfCounters_Test)
+
+
+// The counters are process wide, so only differences are checked
+
+BOOST_AUTO_TEST_CASE(sumsOverThreads)
+{
+	PerfCounters::setNumChannels(2);
+	PerfCounters::Snapshot before = PerfCounters::read();
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; t++)
+	{
+		threads.push_back(std::thread([]() {
+			for (int i = 0; i < 10000; i++)
+			{
+				PerfCounters::add(PerfCounters::LINES);
+				PerfCounters::addSamples(1);
+			}
+			PerfCounters::addTime(PerfCounters::FRAME_NS, std::chrono::microseconds(3));
+		}));
+	}
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	// Counts of exited threads are kept
+	PerfCounters::Snapshot after = PerfCounters::read();
+	BOOST_REQUIRE_EQUAL(2, after.getNumChannels());
+	BOOST_CHECK_EQUAL(40000, after.get(PerfCounters::LINES) - before.get(PerfCounters::LINES));
+	BOOST_CHECK_EQUAL(40000, after.getSamples(1) - before.getSamples(1));
+	BOOST_CHECK_EQUAL(0, after.getSamples(0) - before.getSamples(0));
+	BOOST_CHECK_EQUAL(12000, after.get(PerfCounters::FRAME_NS) - before.get(PerfCounters::FRAME_NS));
+}
+
+BOOST_AUTO_TEST_CASE(unknownChannelIgnored)
+{
+	PerfCounters::setNumChannels(2);
+	std::thread([]() {
+		PerfCounters::addSamples(2);
+		PerfCounters::addSamples(100);
+	}).join();
+
+	BOOST_CHECK_EQUAL(2, PerfCounters::read().getNumChannels());
+}
+
+BOOST_AUTO_TEST_CASE(enabled)
+{
+	PerfCounters::setEnabled(true);
+	BOOST_CHECK(PerfCounters::isEnabled());
+	PerfCounters::setEnabled(false);
+	BOOST_CHECK(!PerfCounters::isEnabled());
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
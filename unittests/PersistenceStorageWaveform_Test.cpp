@@ -0,0 +1,129 @@
+/*
+ * PersistenceStorageWaveform_Test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../StreamProcessors/PersistenceStorageWaveform.hpp"
+
+#include <limits>
+
+
+static uint32_t totalHits(const IntensityGrid& grid)
+{
+	uint32_t sum = 0;
+	for (int row = 0; row < grid.getRows(); row++)
+	{
+		for (int column = 0; column < grid.getColumns(); column++)
+		{
+			sum += grid.get(column, row);
+		}
+	}
+	return sum;
+}
+
+
+BOOST_AUTO_TEST_SUITE(PersistenceStorageWaveform_Test)
+
+
+BOOST_AUTO_TEST_CASE(construction)
+{
+	PersistenceStorageWaveform<double> w;
+}
+
+BOOST_AUTO_TEST_CASE(fixedRangeHits)
+{
+	// 8 samples per sweep over 8 columns, 10 rows covering [0, 10)
+	PersistenceStorageWaveform<double> w(8, 8, 10, 1);
+	w.setRange(0, 10);
+
+	w.push(0.5);
+	w.push(3.5);
+	w.push(9.5);
+	w.push(20); // Outside of range, not counted
+
+	const IntensityGrid& grid = w.getGrid();
+	BOOST_CHECK_EQUAL(1, grid.get(0, 0));
+	BOOST_CHECK_EQUAL(1, grid.get(1, 3));
+	BOOST_CHECK_EQUAL(1, grid.get(2, 9));
+	BOOST_CHECK_EQUAL(3, totalHits(grid));
+
+	BOOST_CHECK_EQUAL(4, w.getWaveform().size());
+	BOOST_CHECK_EQUAL(20, w.getLastSample());
+}
+
+BOOST_AUTO_TEST_CASE(decayWhenSweepReturns)
+{
+	// 2 samples per column and sweep
+	PersistenceStorageWaveform<double> w(4, 2, 2, 1);
+	w.setRange(0, 2);
+
+	for (int i = 0; i < 3; i++)
+	{
+		w.push(0.5);
+		w.push(0.5);
+		w.push(1.5);
+		w.push(1.5);
+	}
+
+	// Each time the sweep enters a column, half (rounded up) of the hits are removed
+	BOOST_CHECK_EQUAL(1, w.getGrid().get(0, 0));
+	BOOST_CHECK_EQUAL(3, w.getGrid().get(1, 1));
+
+	// Even a single hit fades away
+	for (int i = 0; i < 4; i++)
+	{
+		w.push(1.5);
+	}
+	BOOST_CHECK_EQUAL(0, w.getGrid().get(0, 0));
+}
+
+BOOST_AUTO_TEST_CASE(rangeGrowsWithoutLosingHits)
+{
+	PersistenceStorageWaveform<double> w(8, 8, 16, 1);
+
+	w.push(1);
+	w.push(-50);
+	w.push(1000);
+	w.push(2);
+
+	BOOST_CHECK_EQUAL(4, totalHits(w.getGrid()));
+	BOOST_CHECK(w.getRangeMin() <= -50);
+	BOOST_CHECK(w.getRangeMax() > 1000);
+
+	BOOST_CHECK_EQUAL(-50, w.getWaveform()[1].min);
+	BOOST_CHECK_EQUAL(1000, w.getWaveform()[2].max);
+}
+
+BOOST_AUTO_TEST_CASE(nonFiniteSamplesLeftOut)
+{
+	const double inf = std::numeric_limits<double>::infinity();
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+
+	// Also as the very first samples, before there is a range
+	PersistenceStorageWaveform<double> w(8, 8, 16, 1);
+	w.push(inf);
+	w.push(-inf);
+	w.push(nan);
+	w.push(1);
+	w.push(inf);
+	w.push(2);
+	w.push(-inf);
+	w.push(nan);
+
+	BOOST_CHECK_EQUAL(2, totalHits(w.getGrid()));
+	BOOST_CHECK(isfinite(w.getRangeMin()));
+	BOOST_CHECK(isfinite(w.getRangeMax()));
+	BOOST_CHECK(w.getRangeMin() <= 1);
+	BOOST_CHECK(w.getRangeMax() > 2);
+	BOOST_CHECK_EQUAL(2, w.getWaveform().size());
+	BOOST_CHECK(isnan(w.getLastSample()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
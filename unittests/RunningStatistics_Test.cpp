@@ -0,0 +1,76 @@
+/*
+ * RunningStatistics_Test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+
+#include "../StreamProcessors/RunningStatistics.hpp"
+
+
+BOOST_AUTO_TEST_SUITE(RunningStatistics_Test)
+
+
+BOOST_AUTO_TEST_CASE(empty)
+{
+	RunningStatistics dut;
+	BOOST_CHECK_EQUAL(dut.getCount(), 0);
+	BOOST_CHECK_EQUAL(dut.getMean(), 0);
+	BOOST_CHECK_EQUAL(dut.getStdDev(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(singleSample)
+{
+	RunningStatistics dut;
+	dut.push(3.5);
+	BOOST_CHECK_EQUAL(dut.getCount(), 1);
+	BOOST_CHECK_EQUAL(dut.getMean(), 3.5);
+	BOOST_CHECK_EQUAL(dut.getVariance(), 0);
+	BOOST_CHECK_EQUAL(dut.getMin(), 3.5);
+	BOOST_CHECK_EQUAL(dut.getMax(), 3.5);
+}
+
+BOOST_AUTO_TEST_CASE(moments)
+{
+	RunningStatistics dut;
+	const double values[] = { 2, 4, 4, 4, 5, 5, 7, 9 };
+	for (double value : values)
+	{
+		dut.push(value);
+	}
+	BOOST_CHECK_EQUAL(dut.getCount(), 8);
+	BOOST_CHECK_CLOSE(dut.getMean(), 5.0, 1e-9);
+	BOOST_CHECK_CLOSE(dut.getVariance(), 32.0 / 7, 1e-9);
+	BOOST_CHECK_EQUAL(dut.getMin(), 2);
+	BOOST_CHECK_EQUAL(dut.getMax(), 9);
+}
+
+BOOST_AUTO_TEST_CASE(largeOffset)
+{
+	// Summing squares would lose all precision here
+	RunningStatistics dut;
+	for (int i = 0; i < 1000; i++)
+	{
+		dut.push(1e9 + (i % 2 ? 1 : -1));
+	}
+	BOOST_CHECK_CLOSE(dut.getMean(), 1e9, 1e-9);
+	BOOST_CHECK_CLOSE(dut.getVariance(), 1000.0 / 999, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(reset)
+{
+	RunningStatistics dut;
+	dut.push(100);
+	dut.reset();
+	dut.push(-1);
+	BOOST_CHECK_EQUAL(dut.getCount(), 1);
+	BOOST_CHECK_EQUAL(dut.getMax(), -1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
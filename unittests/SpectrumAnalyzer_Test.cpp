@@ -0,0 +1,104 @@
+/*
+ * SpectrumAnalyzer_Test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../StreamProcessors/SpectrumAnalyzer.hpp"
+
+
+namespace {
+
+std::vector<double> sine(size_t size, double cycles, double amplitude)
+{
+	std::vector<double> samples(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		samples[i] = amplitude * sin(2 * M_PI * cycles * i / size);
+	}
+	return samples;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(SpectrumAnalyzer_Test)
+
+
+BOOST_AUTO_TEST_CASE(parseWindow)
+{
+	SpectrumAnalyzer::Window window = SpectrumAnalyzer::RECTANGULAR;
+	BOOST_CHECK(SpectrumAnalyzer::parseWindow("hann", window));
+	BOOST_CHECK_EQUAL(window, SpectrumAnalyzer::HANN);
+	BOOST_CHECK(SpectrumAnalyzer::parseWindow("blackman", window));
+	BOOST_CHECK_EQUAL(window, SpectrumAnalyzer::BLACKMAN);
+	BOOST_CHECK(!SpectrumAnalyzer::parseWindow("kaiser", window));
+}
+
+BOOST_AUTO_TEST_CASE(sineOfAmplitudeOneIsZeroDb)
+{
+	const SpectrumAnalyzer::Window windows[] = {
+			SpectrumAnalyzer::RECTANGULAR, SpectrumAnalyzer::HANN,
+			SpectrumAnalyzer::HAMMING, SpectrumAnalyzer::BLACKMAN };
+	for (auto window : windows)
+	{
+		SpectrumAnalyzer analyzer(512, window);
+		BOOST_CHECK_EQUAL(analyzer.getNumBins(), 257);
+		analyzer.add(&sine(512, 32, 1.0)[0]);
+
+		std::vector<double> magnitudes;
+		analyzer.getMagnitudesDb(magnitudes);
+		BOOST_CHECK_SMALL(magnitudes[32], 1e-6);
+		BOOST_CHECK_EQUAL(std::max_element(magnitudes.begin(), magnitudes.end()) - magnitudes.begin(), 32);
+		// Far from the peak, only leakage (none for these windows)
+		BOOST_CHECK_LT(magnitudes[100], -100);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(hannLeaksLessBetweenBins)
+{
+	SpectrumAnalyzer rectangular(512, SpectrumAnalyzer::RECTANGULAR);
+	SpectrumAnalyzer hann(512, SpectrumAnalyzer::HANN);
+	const std::vector<double> samples = sine(512, 32.5, 1.0);
+	rectangular.add(&samples[0]);
+	hann.add(&samples[0]);
+
+	std::vector<double> rectangularDb, hannDb;
+	rectangular.getMagnitudesDb(rectangularDb);
+	hann.getMagnitudesDb(hannDb);
+	BOOST_CHECK_LT(hannDb[100], rectangularDb[100] - 30);
+}
+
+BOOST_AUTO_TEST_CASE(averaging)
+{
+	SpectrumAnalyzer analyzer(256, SpectrumAnalyzer::HANN, 2);
+	std::vector<double> magnitudes;
+
+	analyzer.add(&sine(256, 16, 1.0)[0]);
+	analyzer.add(&sine(256, 16, 3.0)[0]);
+	analyzer.getMagnitudesDb(magnitudes);
+	// The average power of the two: (1 + 9) / 2
+	BOOST_CHECK_CLOSE(magnitudes[16], 10 * log10(5.0), 1e-6);
+
+	analyzer.reset();
+	analyzer.add(&sine(256, 16, 2.0)[0]);
+	analyzer.getMagnitudesDb(magnitudes);
+	BOOST_CHECK_CLOSE(magnitudes[16], 10 * log10(4.0), 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(silenceIsTheFloor)
+{
+	SpectrumAnalyzer analyzer(64);
+	std::vector<double> silence(64, 0.0);
+	analyzer.add(&silence[0]);
+	std::vector<double> magnitudes;
+	analyzer.getMagnitudesDb(magnitudes, -150);
+	BOOST_CHECK_EQUAL(magnitudes[5], -150);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,129 @@
+/*
+ * TriggerCapture_Test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../StreamProcessors/TriggerCapture.hpp"
+
+#include <stdint.h>
+
+
+BOOST_AUTO_TEST_SUITE(TriggerCapture_Test)
+
+
+BOOST_AUTO_TEST_CASE(construction)
+{
+	TriggerCapture<int16_t> dut(2, 0, 5, TriggerCapture<int16_t>::RISING, 3, 3);
+	BOOST_CHECK_EQUAL(0, dut.getNumCaptures());
+	BOOST_CHECK_EQUAL(6, dut.getWindowSize());
+}
+
+BOOST_AUTO_TEST_CASE(risingEdge)
+{
+	TriggerCapture<int16_t> dut(1, 0, 5, TriggerCapture<int16_t>::RISING, 2, 3);
+
+	int16_t samples[] = { 9, 1, 2, 3, 6, 7, 8, 9 };
+	for (auto sample : samples)
+	{
+		dut.push(0, sample);
+	}
+
+	BOOST_REQUIRE_EQUAL(1, dut.getNumCaptures());
+	const auto& capture = dut.getCapture(0);
+	BOOST_CHECK_EQUAL(0, capture.offset);
+	BOOST_REQUIRE_EQUAL(5, capture.samples.size());
+	BOOST_CHECK_EQUAL(2, capture.samples[0]);
+	BOOST_CHECK_EQUAL(3, capture.samples[1]);
+	BOOST_CHECK_EQUAL(6, capture.samples[2]); // Trigger event
+	BOOST_CHECK_EQUAL(7, capture.samples[3]);
+	BOOST_CHECK_EQUAL(8, capture.samples[4]);
+}
+
+BOOST_AUTO_TEST_CASE(fallingEdgeIgnoresRisingEdge)
+{
+	TriggerCapture<int16_t> dut(1, 0, 5, TriggerCapture<int16_t>::FALLING, 1, 1);
+
+	dut.push(0, 1);
+	dut.push(0, 6); // rising, ignored
+	BOOST_CHECK_EQUAL(0, dut.getNumCaptures());
+
+	dut.push(0, 4); // falling
+	BOOST_REQUIRE_EQUAL(1, dut.getNumCaptures());
+	BOOST_CHECK_EQUAL(6, dut.getCapture(0).samples[0]);
+	BOOST_CHECK_EQUAL(4, dut.getCapture(0).samples[1]);
+}
+
+BOOST_AUTO_TEST_CASE(shortPreTriggerHistoryIsOffset)
+{
+	TriggerCapture<int16_t> dut(1, 0, 5, TriggerCapture<int16_t>::RISING, 4, 2);
+
+	dut.push(0, 0);
+	dut.push(0, 10);
+	dut.push(0, 11);
+
+	BOOST_REQUIRE_EQUAL(1, dut.getNumCaptures());
+	BOOST_CHECK_EQUAL(3, dut.getCapture(0).offset);
+	BOOST_CHECK_EQUAL(3, dut.getCapture(0).samples.size());
+}
+
+BOOST_AUTO_TEST_CASE(allChannelsFrozenTogether)
+{
+	// Trigger on channel 1
+	TriggerCapture<int16_t> dut(2, 1, 5, TriggerCapture<int16_t>::RISING, 2, 2);
+
+	for (int16_t i = 0; i < 4; i++)
+	{
+		dut.push(0, 100 + i);
+		dut.push(1, 0);
+	}
+
+	dut.push(0, 104);
+	dut.push(1, 10); // Trigger event
+	dut.push(0, 105);
+	BOOST_CHECK_EQUAL(0, dut.getNumCaptures());
+	dut.push(1, 11);
+
+	BOOST_REQUIRE_EQUAL(1, dut.getNumCaptures());
+	const auto& channel0 = dut.getCapture(0);
+	BOOST_REQUIRE_EQUAL(3, channel0.samples.size());
+	BOOST_CHECK_EQUAL(103, channel0.samples[0]);
+	BOOST_CHECK_EQUAL(104, channel0.samples[1]);
+	BOOST_CHECK_EQUAL(105, channel0.samples[2]);
+
+	// Re-arms, and keeps the completed capture until the next one is done
+	dut.push(1, 0);
+	dut.push(1, 20);
+	BOOST_CHECK_EQUAL(1, dut.getNumCaptures());
+	dut.push(1, 21);
+	BOOST_CHECK_EQUAL(2, dut.getNumCaptures());
+	BOOST_CHECK_EQUAL(20, dut.getCapture(1).samples[2]);
+}
+
+BOOST_AUTO_TEST_CASE(channelWithoutNewSamplesCatchesUpWhenRead)
+{
+	TriggerCapture<int16_t> dut(2, 1, 5, TriggerCapture<int16_t>::RISING, 2, 2);
+
+	dut.push(0, 100);
+	dut.push(0, 101);
+	dut.push(0, 102);
+	dut.push(1, 0);
+	dut.push(1, 10); // Trigger event, with no more samples of channel 0
+	dut.push(1, 11);
+	dut.push(1, 12);
+
+	BOOST_REQUIRE_EQUAL(1, dut.getNumCaptures());
+	const auto& channel0 = dut.getCapture(0);
+	BOOST_CHECK_EQUAL(0, channel0.offset);
+	BOOST_REQUIRE_EQUAL(2, channel0.samples.size());
+	BOOST_CHECK_EQUAL(101, channel0.samples[0]);
+	BOOST_CHECK_EQUAL(102, channel0.samples[1]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,156 @@
+/*
+ * WaveformExporter_Test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../WaveformExporter.hpp"
+
+#include <glob.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+BOOST_AUTO_TEST_SUITE(WaveformExporter_Test)
+
+
+static std::vector<WaveformExporter::Channel> testChannels()
+{
+	std::vector<WaveformExporter::Channel> channels(2);
+	channels[0].name = "a";
+	channels[0].waveform.push_back(MinMax<double>(1, 2));
+	channels[0].waveform.push_back(MinMax<double>(-0.5, 3));
+	channels[1].name = "b";
+	channels[1].waveform.push_back(MinMax<double>(7, 7));
+	return channels;
+}
+
+static std::string readAll(FILE* f)
+{
+	std::string contents;
+	rewind(f);
+	int c;
+	while ((c = fgetc(f)) != EOF)
+	{
+		contents += char(c);
+	}
+	return contents;
+}
+
+BOOST_AUTO_TEST_CASE(csv)
+{
+	FILE* f = tmpfile();
+	BOOST_REQUIRE(f);
+	BOOST_CHECK(WaveformExporter::writeCSV(f, testChannels()));
+	BOOST_CHECK_EQUAL(
+			"index,a min,a max,b min,b max\n"
+			"0,1,2,7,7\n"
+			"1,-0.5,3,,\n",
+			readAll(f));
+	fclose(f);
+}
+
+BOOST_AUTO_TEST_CASE(binary)
+{
+	FILE* f = tmpfile();
+	BOOST_REQUIRE(f);
+	BOOST_CHECK(WaveformExporter::writeBinary(f, testChannels()));
+	std::string contents = readAll(f);
+	fclose(f);
+
+	// magic + count, then name length + name + point count + points per channel
+	BOOST_REQUIRE_EQUAL(12 + (4 + 1 + 8 + 2 * 16) + (4 + 1 + 8 + 1 * 16), contents.size());
+	BOOST_CHECK_EQUAL("RMDPEXP\n", contents.substr(0, 8));
+
+	double secondMin;
+	memcpy(&secondMin, &contents[12 + 4 + 1 + 8 + 16], sizeof(secondMin));
+	BOOST_CHECK_EQUAL(-0.5, secondMin);
+}
+
+BOOST_AUTO_TEST_CASE(historyLongerThanView)
+{
+	// 8 view points, but every one of the samples is exported
+	auto history = std::make_shared<CompressedStorageWaveform<double> >(8);
+	for (int i = 0; i < 5000; i++)
+	{
+		history->push(i * 0.25);
+	}
+	std::vector<WaveformExporter::Channel> channels = testChannels();
+	channels[1].history = history;
+
+	FILE* f = tmpfile();
+	BOOST_REQUIRE(f);
+	BOOST_CHECK(WaveformExporter::writeCSV(f, channels));
+	std::istringstream csv(readAll(f));
+	fclose(f);
+
+	std::string line;
+	std::getline(csv, line);
+	BOOST_CHECK_EQUAL("index,a min,a max,b min,b max", line);
+	for (int i = 0; i < 5000; i++)
+	{
+		BOOST_REQUIRE(std::getline(csv, line));
+		std::ostringstream expected;
+		expected << i << ",";
+		if (i < 2)
+		{
+			expected << testChannels()[0].waveform[i].min << "," << testChannels()[0].waveform[i].max;
+		}
+		else
+		{
+			expected << ",";
+		}
+		expected << "," << i * 0.25 << "," << i * 0.25;
+		BOOST_REQUIRE_EQUAL(expected.str(), line);
+	}
+	BOOST_CHECK(!std::getline(csv, line));
+
+	f = tmpfile();
+	BOOST_REQUIRE(f);
+	BOOST_CHECK(WaveformExporter::writeBinary(f, channels));
+	std::string contents = readAll(f);
+	fclose(f);
+	BOOST_REQUIRE_EQUAL(12 + (4 + 1 + 8 + 2 * 16) + (4 + 1 + 8 + 5000 * 16), contents.size());
+	double lastMax;
+	memcpy(&lastMax, &contents[contents.size() - 8], sizeof(lastMax));
+	BOOST_CHECK_EQUAL(4999 * 0.25, lastMax);
+}
+
+BOOST_AUTO_TEST_CASE(backgroundExport)
+{
+	char directory[] = "/tmp/WaveformExporter_TestXXXXXX";
+	BOOST_REQUIRE(mkdtemp(directory));
+	const std::string prefix = std::string(directory) + "/export-";
+
+	{
+		WaveformExporter dut(prefix, WaveformExporter::CSV);
+		std::vector<WaveformExporter::Channel> channels = testChannels();
+		BOOST_CHECK(dut.exportSnapshot(channels));
+		BOOST_CHECK(channels.empty());
+	} // Waits for the file to be written
+
+	glob_t found;
+	BOOST_REQUIRE_EQUAL(0, glob((prefix + "*-0.csv").c_str(), 0, 0, &found));
+	BOOST_REQUIRE_EQUAL(1, found.gl_pathc);
+	FILE* f = fopen(found.gl_pathv[0], "r");
+	BOOST_REQUIRE(f);
+	BOOST_CHECK_EQUAL(0, readAll(f).find("index,a min,a max,b min,b max\n"));
+	fclose(f);
+
+	unlink(found.gl_pathv[0]);
+	globfree(&found);
+	rmdir(directory);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,139 @@
+/*
+ * XYDensityGrid_Test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *  Copyright (c) 2016 Simon Gustafsson (www.optisimon.com)
+ *  Do whatever you like with this code, but please refer to me as the original author.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../StreamProcessors/XYDensityGrid.hpp"
+
+#include <limits>
+
+namespace {
+
+uint64_t totalHits(const IntensityGrid& grid)
+{
+	uint64_t total = 0;
+	for (int row = 0; row < grid.getRows(); row++)
+	{
+		for (int column = 0; column < grid.getColumns(); column++)
+		{
+			total += grid.get(column, row);
+		}
+	}
+	return total;
+}
+
+// Long enough for nothing to decay in the tests
+const int noDecay = std::numeric_limits<int>::max();
+
+}
+
+BOOST_AUTO_TEST_SUITE(XYDensityGrid_Test)
+
+
+BOOST_AUTO_TEST_CASE(fixedRange)
+{
+	XYDensityGrid density(4, 2, noDecay);
+	density.setRange(0, 4, 0, 2);
+
+	density.push(0.5, 0.5);
+	density.push(3.5, 1.5);
+	density.push(3.9, 1.9);
+	density.push(4.0, 1.0);  // Outside
+	density.push(-0.1, 1.0); // Outside
+	density.push(std::numeric_limits<double>::quiet_NaN(), 1.0);
+
+	const IntensityGrid& grid = density.getGrid();
+	BOOST_CHECK_EQUAL(grid.get(0, 0), 1);
+	BOOST_CHECK_EQUAL(grid.get(3, 1), 2);
+	BOOST_CHECK_EQUAL(totalHits(grid), 3);
+	BOOST_CHECK_EQUAL(density.getRangeMinX(), 0);
+	BOOST_CHECK_EQUAL(density.getRangeMaxX(), 4);
+	BOOST_CHECK_EQUAL(density.getRangeMaxY(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(rangeGrowsToFitKeepingHits)
+{
+	XYDensityGrid density(64, 32, noDecay);
+	const double points[][2] = { { 1, 1 }, { 1.001, 0.999 }, { -3, 7 }, { 250, -40 }, { 0, 0 }, { -1000, 1e4 } };
+	for (const auto& point : points)
+	{
+		density.push(point[0], point[1]);
+		BOOST_CHECK_LE(density.getRangeMinX(), point[0]);
+		BOOST_CHECK_GT(density.getRangeMaxX(), point[0]);
+		BOOST_CHECK_LE(density.getRangeMinY(), point[1]);
+		BOOST_CHECK_GT(density.getRangeMaxY(), point[1]);
+	}
+	BOOST_CHECK_EQUAL(totalHits(density.getGrid()), sizeof(points) / sizeof(points[0]));
+
+	// The last point is where it should be
+	const IntensityGrid& grid = density.getGrid();
+	const int column = int((-1000 - density.getRangeMinX()) * grid.getColumns() /
+			(density.getRangeMaxX() - density.getRangeMinX()));
+	const int row = int((1e4 - density.getRangeMinY()) * grid.getRows() /
+			(density.getRangeMaxY() - density.getRangeMinY()));
+	BOOST_CHECK_GE(grid.get(column, row), 1);
+}
+
+BOOST_AUTO_TEST_CASE(oldPointsFade)
+{
+	XYDensityGrid density(4, 4, 16, 1);
+	density.setRange(0, 4, 0, 4);
+	for (int i = 0; i < 100; i++)
+	{
+		density.push(1.5, 2.5);
+	}
+	const uint32_t steady = density.getGrid().get(1, 2);
+	BOOST_CHECK_GT(steady, 0);
+	BOOST_CHECK_LT(steady, 100);
+
+	// Points elsewhere, until the old ones have faded completely
+	for (int i = 0; i < 16 * 32; i++)
+	{
+		density.push(0.5, 0.5);
+	}
+	BOOST_CHECK_EQUAL(density.getGrid().get(1, 2), 0);
+	BOOST_CHECK_GT(density.getGrid().get(0, 0), 0);
+}
+
+BOOST_AUTO_TEST_CASE(nonFinitePointsNotCounted)
+{
+	const double inf = std::numeric_limits<double>::infinity();
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+
+	// Also as the very first points, before there is a range
+	XYDensityGrid density(8, 8, noDecay);
+	density.push(inf, 1);
+	density.push(1, -inf);
+	density.push(nan, nan);
+	density.push(1, 1);
+	density.push(2, 2);
+	density.push(inf, 1);
+	density.push(1, -inf);
+	density.push(nan, 1);
+
+	BOOST_CHECK_EQUAL(totalHits(density.getGrid()), 2);
+	BOOST_CHECK(isfinite(density.getRangeMinX()));
+	BOOST_CHECK(isfinite(density.getRangeMaxX()));
+	BOOST_CHECK(isfinite(density.getRangeMinY()));
+	BOOST_CHECK(isfinite(density.getRangeMaxY()));
+	BOOST_CHECK_GT(density.getRangeMaxX(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(clearForgetsTheRange)
+{
+	XYDensityGrid density(4, 4, noDecay);
+	density.push(1000, 1000);
+	density.clear();
+	density.push(1, 1);
+	BOOST_CHECK_EQUAL(totalHits(density.getGrid()), 1);
+	BOOST_CHECK_LT(density.getRangeMaxX(), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()